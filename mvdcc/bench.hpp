@@ -0,0 +1,144 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "metrics.hpp"
+#include "partitioner.hpp"
+#include "workload.hpp"
+#include "txn_source.hpp"
+#include "command_log.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Parameters of One Benchmark Run
+struct BenchConfig {
+    std::string protocol = "bohm";
+    size_t thread_num = 1;
+    size_t cc_thread_num = 0;       // Workers Starting Out in the CC Phase; 0 for Half of Them
+    bool adaptive_split = false;    // Move Workers Between the CC and Execution Phases at Runtime
+    size_t tuple_num = 0;
+    bool sparse_keys = false;       // Spread Record IDs Over 64 Bits Instead of 0..tuple_num
+    size_t payload_size = 8;        // Bytes per Record Image, a Multiple of 8
+    size_t batch_size = 1;
+    uint64_t batch_timeout_us = 0;  // A Partial Batch Is Cut This Long After Its First Transaction
+    PartitionStrategy strategy = PartitionStrategy::MODULO;
+    WorkloadConfig workload;
+    SourceConfig source;            // Clients, Offered Load and Transaction Limit
+    double duration_sec = 0.0;      // The Run Stops Early Once a Limited Source Is Done
+    size_t reader_num = 0;          // Threads Running Read-Only Transactions Beside the Pipeline
+    bool numa = false;              // Pin Workers and Place Each Partition on Its Owner's Node
+    bool huge_pages = false;        // Back the Table and Its Index With Transparent Huge Pages
+    std::string log_path;           // Command Log, Rewritten Every Run Unless log_sync Is OFF
+    LogSync log_sync = LogSync::OFF;
+    uint64_t log_window_us = 0;     // Group Commit Window of LogSync::WINDOW
+    std::string replay_path;        // Replay This Command Log Instead of Running Clients
+    std::string checkpoint_path;    // Background Checkpoints Go Here
+    uint64_t checkpoint_interval_ms = 0;
+    std::string snapshot_path;      // Start From This Snapshot Instead of an Empty Table
+};
+
+// Outcome of One Run
+struct RunReport {
+    double elapsed_sec = 0.0;
+    double load_sec = 0.0;          // Startup: Building or Mapping the Table and Its Indexes
+    std::vector<Result> results;    // Per Thread, Merged by the Driver
+    double avg_chain_length = 0.0;  // Versions per Record at the End of the Run
+    double avg_cc_threads = 0.0;    // CC Threads per Batch, Averaged Over the Batches
+    LogStats log;                   // Command Log I/O
+};
+
+// Protocol Entry Points: Each Rebuilds Its Own State, So Runs Can Be Repeated
+RunReport runBohm(const BenchConfig& config);   // protocol/bohm.cpp: Pipelined CC and Execution, Logged
+RunReport runBohmCC(const BenchConfig& config); // mvdcc: BOHM CC Phase Only
+RunReport runGato(const BenchConfig& config);   // mvdcc: Gato CC Phase Only
+
+// How the Workers Are Split: "auto", "half" or the Number of CC Threads
+inline std::string ccThreadsName(const BenchConfig& config) {
+    if (config.adaptive_split) return "auto";
+    return config.cc_thread_num ? std::to_string(config.cc_thread_num) : "half";
+}
+
+inline Result mergeResults(const std::vector<Result>& results) {
+    Result total;
+    for (const auto& result : results) total.merge(result);
+    return total;
+}
+
+// CSV Output: One Row per Measured Trial
+inline std::string csvHeader() {
+    return "tag,protocol,threads,tuples,payload,txns,batch_size,batch_timeout_us,partition,numa,"
+           "log_sync,distribution,theta,read_ratio,rmw_ratio,min_ops,max_ops,clients,offered_rate,"
+           "arrival,trial,elapsed_sec,commits,throughput,"
+           "retries,aborts,placeholders,cc_phase_p99_ns,e2e_p50_ns,e2e_p99_ns,e2e_p999_ns,"
+           "avg_chain_length,log_bytes,log_syncs,readers,read_only_commits,read_only_throughput,"
+           "read_only_p99_ns,scan_ratio,scan_length,scans,scanned_records,keys,insert_ratio,inserts,huge_pages,load_sec,"
+           "cc_threads,avg_cc_threads";
+}
+
+inline void writeCsvHeader(std::ostream& out) { out << csvHeader() << '\n'; }
+
+inline void writeCsvRow(std::ostream& out, const std::string& tag, const BenchConfig& config,
+                        size_t trial, const RunReport& report) {
+    Result total = mergeResults(report.results);
+    const WorkloadConfig& workload = config.workload;
+    const SourceConfig& source = config.source;
+    out << tag << ',' << config.protocol << ',' << config.thread_num << ',' << config.tuple_num
+        << ',' << config.payload_size << ',' << source.limit << ',' << config.batch_size << ','
+        << config.batch_timeout_us << ','
+        << partitionStrategyName(config.strategy) << ',' << (config.numa ? "on" : "off") << ','
+        << logSyncName(config.log_sync) << ',' << keyDistributionName(workload.distribution) << ',' << workload.theta << ','
+        << workload.read_ratio << ',' << workload.rmw_ratio << ',' << workload.min_ops << ','
+        << workload.max_ops << ',' << source.client_num << ',' << source.rate << ','
+        << (source.poisson ? "poisson" : "fixed") << ',' << trial << ',' << report.elapsed_sec << ','
+        << total.commit_cnt_ << ','
+        << (report.elapsed_sec > 0 ? total.commit_cnt_ / report.elapsed_sec : 0.0) << ','
+        << total.retry_cnt_ << ',' << total.abort_cnt_ << ',' << total.placeholder_cnt_ << ','
+        << total.cc_phase_.percentile(0.99) << ',' << total.end_to_end_.percentile(0.50) << ','
+        << total.end_to_end_.percentile(0.99) << ',' << total.end_to_end_.percentile(0.999) << ','
+        << report.avg_chain_length << ',' << report.log.bytes_ << ',' << report.log.syncs_ << ','
+        << config.reader_num << ',' << total.read_only_cnt_ << ','
+        << (report.elapsed_sec > 0 ? total.read_only_cnt_ / report.elapsed_sec : 0.0) << ','
+        << total.read_only_.percentile(0.99) << ',' << workload.scan_ratio << ','
+        << workload.scan_length << ',' << total.scan_cnt_ << ',' << total.scanned_cnt_ << ','
+        << (config.sparse_keys ? "sparse" : "dense") << ',' << workload.insert_ratio << ','
+        << total.insert_cnt_ << ',' << (config.huge_pages ? "on" : "off") << ',' << report.load_sec << ','
+        << ccThreadsName(config) << ',' << report.avg_cc_threads << '\n';
+}
+
+// JSON Output: Run Parameters Followed by the Merged Metrics of the Trial
+inline void writeRunJson(std::ostream& out, const std::string& tag, const BenchConfig& config,
+                         size_t trial, const RunReport& report) {
+    const WorkloadConfig& workload = config.workload;
+    const SourceConfig& source = config.source;
+    out << "{\"tag\": \"" << tag << "\", \"trial\": " << trial
+        << ", \"tuples\": " << config.tuple_num
+        << ", \"keys\": \"" << (config.sparse_keys ? "sparse" : "dense") << "\""
+        << ", \"payload\": " << config.payload_size
+        << ", \"txns\": " << source.limit
+        << ", \"batch_size\": " << config.batch_size
+        << ", \"batch_timeout_us\": " << config.batch_timeout_us
+        << ", \"partition\": \"" << partitionStrategyName(config.strategy) << "\""
+        << ", \"numa\": " << (config.numa ? "true" : "false")
+        << ", \"huge_pages\": " << (config.huge_pages ? "true" : "false")
+        << ", \"log\": {\"sync\": \"" << logSyncName(config.log_sync) << "\", \"window_us\": "
+        << config.log_window_us << ", \"batches\": " << report.log.batches_ << ", \"bytes\": "
+        << report.log.bytes_ << ", \"syncs\": " << report.log.syncs_ << "}"
+        << ", \"workload\": {\"distribution\": \"" << keyDistributionName(workload.distribution)
+        << "\", \"theta\": " << workload.theta << ", \"read_ratio\": " << workload.read_ratio
+        << ", \"rmw_ratio\": " << workload.rmw_ratio << ", \"scan_ratio\": " << workload.scan_ratio
+        << ", \"scan_length\": " << workload.scan_length << ", \"insert_ratio\": " << workload.insert_ratio
+        << ", \"min_ops\": " << workload.min_ops
+        << ", \"max_ops\": " << workload.max_ops << "}"
+        << ", \"readers\": " << config.reader_num
+        << ", \"cc_threads\": \"" << ccThreadsName(config) << "\""
+        << ", \"source\": {\"clients\": " << source.client_num << ", \"offered_rate\": " << source.rate
+        << ", \"arrival\": \"" << (source.poisson ? "poisson" : "fixed") << "\"}"
+        << ", \"avg_chain_length\": " << report.avg_chain_length
+        << ", \"avg_cc_threads\": " << report.avg_cc_threads
+        << ", \"load_sec\": " << report.load_sec << ",\n\"metrics\": ";
+    writeMetricsJson(out, config.protocol.c_str(), report.results, report.elapsed_sec);
+    out << "}";
+}
+
+#endif // BENCH_HPP
@@ -0,0 +1,439 @@
+#include "config.hpp"
+#include "common.hpp"
+#include "bohm_cc.hpp"
+#include "gato_cc.hpp"
+#include "bench.hpp"
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <stdexcept>
+
+// Global Variables of the mvdcc Protocols (bohm-cc, gato)
+Tuple* Table = nullptr;                                   // Database Table
+PageArray<Tuple> table_pages;                             // Backs Table
+PageArray<char> image_pages;                              // Initial Record Images
+TransactionSource<Transaction> txn_source;                // Client Stream
+uint64_t tx_counter = 0;                                  // Transactions Through the CC Phase
+size_t batch_size = BATCH_SIZE;                           // Transactions per CC Batch
+uint64_t batch_timeout_ns = BATCH_TIMEOUT_US * 1000;      // Deadline of a Partial Batch
+Partitioner partitioner;                                  // Initial Record Partition
+std::vector<int64_t> thread_load;                         // Load Status of Each Thread
+HeatTracker heat_tracker;                                 // Sampled Access Heat
+RecordMap record_to_thread;                               // Record-to-Thread Mapping
+RecordMap last_writer;                                    // Last Write Thread
+MigrationInbox migration_inbox;                           // Gato Ranges in Transit
+std::vector<Result> AllResult;                            // Store Performance Results
+std::vector<VersionArena> cc_arenas;                      // Version Arena Per CC Thread
+CCWatermark cc_watermark;                                 // Oldest Timestamp in the CC Phase
+
+// Common Setup of the mvdcc Protocols
+void prepareRun(const BenchConfig& config) {
+    tx_counter = 0;
+    batch_size = config.batch_size;
+    batch_timeout_ns = config.batch_timeout_us * 1000;
+    AllResult.assign(config.thread_num, Result());
+    initializeArenas(config.thread_num, config.payload_size);
+    cc_watermark.init(config.thread_num);
+}
+
+// Builds the Table Once the Partition Is Known; in NUMA Mode the CC Threads
+// Are Pinned and the Placement of the Records Is Reported
+ThreadPlacement loadDB(const BenchConfig& config) {
+    ThreadPlacement placement;
+    if (config.numa) placement = ThreadPlacement(NumaTopology(), {config.thread_num});
+    makeDB(config.tuple_num, config.payload_size, placement, config.huge_pages);
+    if (placement.pinned()) {
+        auto owner = [](uint64_t key) { return partitioner.owner(key); };
+        printPlacement(std::cout, "tuples", samplePlacement(config.tuple_num, placement, 4096, owner,
+                       [](uint64_t key) -> const void* { return &Table[key]; }));
+    }
+    return placement;
+}
+
+// Runs the CC Workers Until a Limited Source Is Consumed or the Duration Expires
+// load_sec Is How Long the Startup Before Them Took
+template <typename Worker>
+RunReport runCCWorkers(const BenchConfig& config, const ThreadPlacement& placement, double load_sec,
+                       Worker worker) {
+    bool start = false;
+    bool quit = false;
+
+    std::vector<std::thread> cc_workers;
+    for (size_t i = 0; i < config.thread_num; ++i) {
+        cc_workers.emplace_back([&, i] {
+            placement.pin(i);
+            worker(i, start, quit);
+        });
+    }
+
+    // Start the Clients, Then Release the Workers and Measure From There;
+    // Timestamps Are the Clients' Sequence Numbers, Shifted Past the Initial Load (0)
+    KeyGenerator keys(config.workload, config.tuple_num, config.thread_num);
+    const WorkloadConfig& workload = config.workload;
+    uint64_t start_ns = nowNanos();
+    txn_source.start(config.source, workload.seed, start_ns,
+                     [&](FastRandom& rng, uint64_t sequence, uint64_t arrival_ns, Transaction& trans) {
+                         makeTransaction(workload, keys, rng, sequence + 1, arrival_ns, trans);
+                     });
+    __atomic_store_n(&start, true, __ATOMIC_SEQ_CST);
+
+    double elapsed = 0.0;
+    uint64_t limit = config.source.limit;
+    while (!(limit && __atomic_load_n(&tx_counter, __ATOMIC_ACQUIRE) >= limit) &&
+           elapsed < config.duration_sec) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        elapsed = (nowNanos() - start_ns) / 1e9;
+    }
+
+    // Send End Signal and Wait for All Threads to Finish
+    __atomic_store_n(&quit, true, __ATOMIC_SEQ_CST);
+    txn_source.stop();
+    for (auto& worker_thread : cc_workers) {
+        worker_thread.join();
+    }
+    elapsed = (nowNanos() - start_ns) / 1e9;
+
+    RunReport report;
+    report.elapsed_sec = elapsed;
+    report.load_sec = load_sec;
+    report.results = AllResult;
+    uint64_t versions = 0;
+    for (size_t i = 0; i < config.tuple_num; ++i) versions += Table[i].chainLength();
+    report.avg_chain_length = config.tuple_num ? static_cast<double>(versions) / config.tuple_num : 0.0;
+    return report;
+}
+
+RunReport runBohmCC(const BenchConfig& config) {
+    uint64_t load_start = nowNanos();
+    prepareRun(config);
+    assignRecordsToCCThreads(config.thread_num, config.tuple_num, config.strategy);
+    ThreadPlacement placement = loadDB(config);
+    return runCCWorkers(config, placement, (nowNanos() - load_start) / 1e9, cc_worker);
+}
+
+RunReport runGato(const BenchConfig& config) {
+    uint64_t load_start = nowNanos();
+    prepareRun(config);
+    thread_load.assign(config.thread_num, 0);
+    assignRecordsToThreads(config.thread_num, config.tuple_num, config.strategy);
+    ThreadPlacement placement = loadDB(config);
+    return runCCWorkers(config, placement, (nowNanos() - load_start) / 1e9, gato_cc_worker);
+}
+
+RunReport runProtocol(const BenchConfig& config) {
+    if (config.protocol != "bohm" && (config.log_sync != LogSync::OFF || !config.replay_path.empty() ||
+                                      !config.checkpoint_path.empty() || !config.snapshot_path.empty() ||
+                                      config.reader_num || config.workload.scan_ratio > 0 ||
+                                      config.workload.insert_ratio > 0 || config.sparse_keys ||
+                                      config.cc_thread_num || config.adaptive_split)) {
+        throw std::invalid_argument("logging, checkpoints, recovery, readers, scans, inserts, sparse keys "
+                                    "and CC thread splits need --protocol bohm");
+    }
+    if (config.protocol == "bohm") return runBohm(config);
+    if (config.protocol == "bohm-cc") return runBohmCC(config);
+    if (config.protocol == "gato") return runGato(config);
+    throw std::invalid_argument("unknown protocol: " + config.protocol);
+}
+
+void printUsage(const char* program) {
+    std::cout
+        << "Usage: " << program << " [options]\n"
+        << "Options marked * take a comma-separated list; the benchmark sweeps every combination.\n"
+        << "  --protocol LIST *   bohm (CC + execution), bohm-cc, gato      [bohm]\n"
+        << "  --threads LIST *    worker threads                            [" << DEFAULT_THREAD_NUM << "]\n"
+        << "  --tuples LIST *     table size                                [" << DEFAULT_TUPLE_NUM << "]\n"
+        << "  --keys NAME         dense or sparse 64-bit record IDs (bohm)   [dense]\n"
+        << "  --payload LIST *    bytes per record image, rounded up to 8   [" << DEFAULT_PAYLOAD_SIZE << "]\n"
+        << "  --batch LIST *      transactions per batch                    [" << BATCH_SIZE << "]\n"
+        << "  --theta LIST *      zipfian skew, 0 < theta < 1               [0.99]\n"
+        << "  --read-ratio LIST * share of reads                            [0.5]\n"
+        << "  --rate LIST *       offered load in txn/sec (0: unthrottled)  [0]\n"
+        << "  --clients N         client threads issuing transactions       [1]\n"
+        << "  --cc-threads N|auto workers in the CC phase, or adapted at runtime (bohm) [half]\n"
+        << "  --readers N         threads running read-only transactions (bohm) [0]\n"
+        << "  --arrival NAME      fixed or poisson inter-arrival times      [fixed]\n"
+        << "  --queue N           client queue capacity                     [" << SOURCE_QUEUE_SIZE << "]\n"
+        << "  --batch-timeout-us N  cut a partial batch after this long     [" << BATCH_TIMEOUT_US << "]\n"
+        << "  --txns N            transactions per run (0: until --duration) [0]\n"
+        << "  --partition NAME    modulo, range, hash, table                [modulo]\n"
+        << "  --numa on|off       pin workers, place partitions on their node [off]\n"
+        << "  --huge-pages on|off back the table with transparent huge pages [off]\n"
+        << "  --log PATH          command log of the sequenced batches (bohm)\n"
+        << "  --log-sync LIST *   off, write, batch (fsync per group), window [batch]\n"
+        << "  --log-window-us N   group commit window of --log-sync window  [" << LOG_WINDOW_US << "]\n"
+        << "  --replay PATH       recover: replay a command log instead of the clients (bohm)\n"
+        << "  --checkpoint PATH   write background checkpoints of the table (bohm)\n"
+        << "  --checkpoint-ms N   interval between checkpoints              [" << CHECKPOINT_INTERVAL_MS << "]\n"
+        << "  --snapshot PATH     start from a checkpoint instead of an empty table (bohm)\n"
+        << "  --dist NAME         uniform, zipfian, hotspot                 [uniform]\n"
+        << "  --rmw-ratio X       share of read-modify-write operations     [0]\n"
+        << "  --scan-ratio X      share of range scans (bohm)               [0]\n"
+        << "  --scan-length N     keys covered by a range scan              [100]\n"
+        << "  --insert-ratio X    share of inserts of new records (bohm)    [0]\n"
+        << "  --ops N             tasks per transaction (sets both bounds)  [" << MAX_OPE << "]\n"
+        << "  --min-ops N, --max-ops N                                      (max " << MAX_OPE << ")\n"
+        << "  --seed N            workload seed                             [42]\n"
+        << "  --duration SEC      time limit per run                        [" << EX_TIME << "]\n"
+        << "  --warmup N          discarded runs per configuration          [1]\n"
+        << "  --trials N          measured runs per configuration           [3]\n"
+        << "  --csv PATH          append one row per measured run\n"
+        << "  --json PATH         write every measured run as JSON          [metrics.json]\n"
+        << "  --tag TEXT          label stored with each run (e.g. a commit id)\n";
+}
+
+template <typename T>
+std::vector<T> parseList(const std::string& text, T (*parse)(const std::string&)) {
+    std::vector<T> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) values.push_back(parse(item));
+    }
+    if (values.empty()) throw std::invalid_argument("empty list: " + text);
+    return values;
+}
+
+size_t parseSize(const std::string& text) { return std::stoul(text); }
+double parseDouble(const std::string& text) { return std::stod(text); }
+std::string parseString(const std::string& text) { return text; }
+
+bool parseSwitch(const std::string& text) {
+    if (text == "on") return true;
+    if (text == "off") return false;
+    throw std::invalid_argument("expected on or off: " + text);
+}
+
+bool parseKeys(const std::string& text) {
+    if (text == "dense") return false;
+    if (text == "sparse") return true;
+    throw std::invalid_argument("unknown key space: " + text);
+}
+
+// Number of CC threads, 0 for the default; "auto" adapts the split
+size_t parseCCThreads(const std::string& text, bool& adaptive) {
+    adaptive = text == "auto";
+    if (adaptive) return 0;
+    size_t cc_thread_num = parseSize(text);
+    if (cc_thread_num == 0) throw std::invalid_argument("expected at least 1 CC thread: " + text);
+    return cc_thread_num;
+}
+
+bool parseArrival(const std::string& text) {
+    if (text == "fixed") return false;
+    if (text == "poisson") return true;
+    throw std::invalid_argument("unknown arrival process: " + text);
+}
+
+double mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double value : values) sum += value;
+    return values.empty() ? 0.0 : sum / values.size();
+}
+
+double stddev(const std::vector<double>& values) {
+    if (values.size() < 2) return 0.0;
+    double average = mean(values);
+    double sum = 0.0;
+    for (double value : values) sum += (value - average) * (value - average);
+    return std::sqrt(sum / (values.size() - 1));
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> protocols = {"bohm"};
+    std::vector<size_t> thread_nums = {DEFAULT_THREAD_NUM};
+    std::vector<size_t> tuple_nums = {DEFAULT_TUPLE_NUM};
+    std::vector<size_t> payload_sizes = {DEFAULT_PAYLOAD_SIZE};
+    std::vector<size_t> batch_sizes = {BATCH_SIZE};
+    std::vector<double> thetas = {0.99};
+    std::vector<double> read_ratios = {0.5};
+    std::vector<double> rates = {0.0};
+    std::vector<LogSync> log_syncs = {LogSync::BATCH};
+    BenchConfig base;
+    base.duration_sec = EX_TIME;
+    base.batch_timeout_us = BATCH_TIMEOUT_US;
+    base.source.queue_capacity = SOURCE_QUEUE_SIZE;
+    base.log_window_us = LOG_WINDOW_US;
+    base.checkpoint_interval_ms = CHECKPOINT_INTERVAL_MS;
+    base.workload.min_ops = base.workload.max_ops = MAX_OPE;
+    size_t warmup = 1;
+    size_t trials = 3;
+    std::string csv_path;
+    std::string json_path = "metrics.json";
+    std::string tag;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string option = argv[i];
+            if (option == "--help" || option == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            }
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + option);
+            std::string value = argv[++i];
+
+            if (option == "--protocol") protocols = parseList(value, parseString);
+            else if (option == "--threads") thread_nums = parseList(value, parseSize);
+            else if (option == "--tuples") tuple_nums = parseList(value, parseSize);
+            else if (option == "--keys") base.sparse_keys = parseKeys(value);
+            else if (option == "--payload") payload_sizes = parseList(value, parseSize);
+            else if (option == "--batch") batch_sizes = parseList(value, parseSize);
+            else if (option == "--theta") thetas = parseList(value, parseDouble);
+            else if (option == "--read-ratio") read_ratios = parseList(value, parseDouble);
+            else if (option == "--rate") rates = parseList(value, parseDouble);
+            else if (option == "--clients") base.source.client_num = parseSize(value);
+            else if (option == "--cc-threads") base.cc_thread_num = parseCCThreads(value, base.adaptive_split);
+            else if (option == "--readers") base.reader_num = parseSize(value);
+            else if (option == "--arrival") base.source.poisson = parseArrival(value);
+            else if (option == "--queue") base.source.queue_capacity = parseSize(value);
+            else if (option == "--batch-timeout-us") base.batch_timeout_us = parseSize(value);
+            else if (option == "--txns") base.source.limit = parseSize(value);
+            else if (option == "--partition") base.strategy = parsePartitionStrategy(value);
+            else if (option == "--numa") base.numa = parseSwitch(value);
+            else if (option == "--huge-pages") base.huge_pages = parseSwitch(value);
+            else if (option == "--log") base.log_path = value;
+            else if (option == "--log-sync") log_syncs = parseList(value, parseLogSync);
+            else if (option == "--log-window-us") base.log_window_us = parseSize(value);
+            else if (option == "--replay") base.replay_path = value;
+            else if (option == "--checkpoint") base.checkpoint_path = value;
+            else if (option == "--checkpoint-ms") base.checkpoint_interval_ms = parseSize(value);
+            else if (option == "--snapshot") base.snapshot_path = value;
+            else if (option == "--dist") base.workload.distribution = parseKeyDistribution(value);
+            else if (option == "--rmw-ratio") base.workload.rmw_ratio = parseDouble(value);
+            else if (option == "--scan-ratio") base.workload.scan_ratio = parseDouble(value);
+            else if (option == "--scan-length") base.workload.scan_length = parseSize(value);
+            else if (option == "--insert-ratio") base.workload.insert_ratio = parseDouble(value);
+            else if (option == "--ops") base.workload.min_ops = base.workload.max_ops = parseSize(value);
+            else if (option == "--min-ops") base.workload.min_ops = parseSize(value);
+            else if (option == "--max-ops") base.workload.max_ops = parseSize(value);
+            else if (option == "--seed") base.workload.seed = std::stoull(value);
+            else if (option == "--duration") base.duration_sec = parseDouble(value);
+            else if (option == "--warmup") warmup = parseSize(value);
+            else if (option == "--trials") trials = parseSize(value);
+            else if (option == "--csv") csv_path = value;
+            else if (option == "--json") json_path = value;
+            else if (option == "--tag") tag = value;
+            else throw std::invalid_argument("unknown option: " + option);
+        }
+        if (base.workload.min_ops == 0 || base.workload.min_ops > base.workload.max_ops ||
+            base.workload.max_ops > MAX_OPE) {
+            throw std::invalid_argument("need 1 <= min-ops <= max-ops <= " + std::to_string(MAX_OPE));
+        }
+        if (base.workload.scan_length == 0) throw std::invalid_argument("scan length must be positive");
+        for (size_t value : thread_nums) {
+            if (value == 0) throw std::invalid_argument("thread count must be positive");
+        }
+        for (size_t& value : payload_sizes) {
+            if (value == 0) throw std::invalid_argument("payload size must be positive");
+            value = (value + 7) / 8 * 8;
+        }
+        for (size_t value : batch_sizes) {
+            if (value == 0) throw std::invalid_argument("batch size must be positive");
+        }
+        if (base.source.client_num == 0) throw std::invalid_argument("need at least one client");
+        if (base.log_path.empty()) log_syncs = {LogSync::OFF};
+        if (!base.replay_path.empty() && !base.log_path.empty()) {
+            throw std::invalid_argument("--replay cannot be combined with --log");
+        }
+        if (base.source.limit == 0 && !(base.duration_sec > 0)) {
+            throw std::invalid_argument("an unlimited source needs a positive --duration");
+        }
+    } catch (const std::exception& error) {
+        std::cerr << "[ERROR] " << error.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // CSV Is Appended To, So Results of Several Commits Accumulate in One File;
+    // Only as Long as Their Columns Agree, Which the Header Line Tells
+    std::ofstream csv_file;
+    if (!csv_path.empty()) {
+        std::ifstream existing(csv_path);
+        std::string header;
+        bool has_header = static_cast<bool>(std::getline(existing, header));
+        if (has_header && header != csvHeader()) {
+            std::cerr << "[ERROR] " << csv_path << " holds columns of another version of the benchmark; "
+                      << "pass a new --csv file" << std::endl;
+            return 1;
+        }
+        csv_file.open(csv_path, std::ios::app);
+        if (!has_header) writeCsvHeader(csv_file);
+    }
+    std::ofstream json_file;
+    if (!json_path.empty()) {
+        json_file.open(json_path);
+        json_file << "[\n";
+    }
+    bool first_json = true;
+
+    for (const auto& protocol : protocols)
+    for (size_t thread_num : thread_nums)
+    for (size_t tuple_num : tuple_nums)
+    for (size_t payload_size : payload_sizes)
+    for (size_t batch : batch_sizes)
+    for (double theta : thetas)
+    for (double read_ratio : read_ratios)
+    for (double rate : rates)
+    for (LogSync log_sync : log_syncs) {
+        BenchConfig config = base;
+        config.protocol = protocol;
+        config.thread_num = thread_num;
+        config.tuple_num = tuple_num;
+        config.payload_size = payload_size;
+        config.batch_size = batch;
+        config.workload.theta = theta;
+        config.workload.read_ratio = read_ratio;
+        config.source.rate = rate;
+        config.log_sync = log_sync;
+
+        std::vector<double> throughputs;
+        std::vector<double> p99s;
+        std::vector<double> read_only_throughputs;
+        std::vector<double> load_secs;
+        try {
+            for (size_t run = 0; run < warmup + trials; ++run) {
+                RunReport report = runProtocol(config);
+                if (run < warmup) continue;
+
+                size_t trial = run - warmup;
+                uint64_t commits = mergeResults(report.results).commit_cnt_;
+                throughputs.push_back(report.elapsed_sec > 0 ? commits / report.elapsed_sec : 0.0);
+                p99s.push_back(mergeResults(report.results).end_to_end_.percentile(0.99) / 1000.0);
+                uint64_t read_only = mergeResults(report.results).read_only_cnt_;
+                read_only_throughputs.push_back(report.elapsed_sec > 0 ? read_only / report.elapsed_sec : 0.0);
+                load_secs.push_back(report.load_sec);
+                if (csv_file.is_open()) writeCsvRow(csv_file, tag, config, trial, report);
+                if (json_file.is_open()) {
+                    json_file << (first_json ? "" : ",\n");
+                    writeRunJson(json_file, tag, config, trial, report);
+                    first_json = false;
+                }
+            }
+        } catch (const std::exception& error) {
+            std::cerr << "[ERROR] " << protocol << " with " << thread_num << " threads: "
+                      << error.what() << std::endl;
+            continue;
+        }
+
+        std::cout << protocol << " threads=" << thread_num << " tuples=" << tuple_num
+                  << " payload=" << payload_size
+                  << " batch=" << batch << " dist=" << keyDistributionName(config.workload.distribution)
+                  << " theta=" << theta << " read_ratio=" << read_ratio
+                  << " offered=" << (rate > 0 ? std::to_string(static_cast<uint64_t>(rate)) : "max")
+                  << " log=" << logSyncName(log_sync)
+                  << ": " << mean(throughputs) << " txn/sec (stddev " << stddev(throughputs)
+                  << "), p99 " << mean(p99s) << " us";
+        if (config.reader_num) {
+            std::cout << ", " << config.reader_num << " readers: " << mean(read_only_throughputs)
+                      << " read-only txn/sec";
+        }
+        std::cout << ", load " << mean(load_secs) * 1000 << " ms, " << throughputs.size() << " trials"
+                  << std::endl;
+    }
+
+    if (json_file.is_open()) json_file << "\n]\n";
+    return 0;
+}
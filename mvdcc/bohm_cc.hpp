@@ -6,69 +6,73 @@
 #include <queue>
 #include <algorithm>
 #include <iostream>
-#include <condition_variable>
-#include <mutex>
 
 // Global Data Definition
 extern std::vector<Result> AllResult; // Store Performance Results per Thread
-extern std::vector<std::vector<uint64_t>> thread_partitions;
+extern Partitioner partitioner;
 
 // Record Distribution Function
-void assignRecordsToCCThreads(size_t cc_thread_num, size_t tuple_num) {
-    thread_partitions.resize(cc_thread_num);
-    for (uint64_t i = 0; i < tuple_num; ++i) {
-        size_t thread_id = i % cc_thread_num;
-        thread_partitions[thread_id].push_back(i);
-    }
+void assignRecordsToCCThreads(size_t cc_thread_num, size_t tuple_num,
+                              PartitionStrategy strategy = PartitionStrategy::MODULO) {
+    partitioner.build(strategy, cc_thread_num, tuple_num);
 }
 
 void cc_worker(int thread_id, const bool& start, const bool& quit) {
+    std::vector<Transaction> local_batch(batch_size);
+    std::vector<uint32_t> order; // Batch Positions in Timestamp Order
+    order.reserve(batch_size);
+    uint64_t batch_num = 0;      // Batches Processed, the Epoch of Retired Versions
+
     while (!__atomic_load_n(&start, __ATOMIC_SEQ_CST)) {}
 
     while (!__atomic_load_n(&quit, __ATOMIC_SEQ_CST)) {
-        std::vector<Transaction> local_batch;
-
         // Retrieve Transaction Batch
-        uint64_t start_pos = __atomic_fetch_add(&tx_counter, BATCH_SIZE, __ATOMIC_SEQ_CST);
-        uint64_t end_pos = std::min(start_pos + BATCH_SIZE, (uint64_t)transactions.size());
-        for (uint64_t i = start_pos; i < end_pos; ++i) {
-            local_batch.emplace_back(transactions[i]);
-        }
+        size_t size = fetchBatch(local_batch.data(), quit);
+
+        if (size == 0) continue;
 
-        // Transaction Sorting
-        std::sort(local_batch.begin(), local_batch.end(), [](const Transaction& a, const Transaction& b) {
-            return a.timestamp_ < b.timestamp_;
+        uint64_t batch_start = nowNanos();
+
+        // Recycle the Versions Retired in Earlier Batches, Then Keep This
+        // Batch's Versions Contiguous in the Thread's Arena
+        cc_arenas[thread_id].reclaim(batch_num++);
+        cc_arenas[thread_id].reserve(size * MAX_OPE);
+
+        // Transaction Sorting (by Position, the Transactions Stay in Place)
+        order.resize(size);
+        for (size_t i = 0; i < size; ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return local_batch[a].timestamp_ < local_batch[b].timestamp_;
         });
+        cc_watermark.enter(thread_id, local_batch[order[0]].timestamp_);
+        uint64_t low_watermark = cc_watermark.low();
 
         // Execute CC Phase
-        for (auto& trans : local_batch) {
+        for (uint32_t position : order) {
+            Transaction& trans = local_batch[position];
             bool is_success = true;
 
-            for (const auto& task : trans.task_set_) {
+            for (uint32_t i = 0; i < trans.task_num_; ++i) {
+                const Task& task = trans.task_set_[i];
                 // Process if the Record is Managed by the Current Thread
-                if (task.ope_ == Ope::WRITE &&
-                    std::find(thread_partitions[thread_id].begin(),
-                              thread_partitions[thread_id].end(),
-                              task.key_) != thread_partitions[thread_id].end()) {
-                    Table[task.key_].addPlaceholder(trans.timestamp_);
-                    trans.write_set_.emplace_back(task.key_);
+                if (task.ope_ == Ope::WRITE && partitioner.owns(thread_id, task.key_)) {
+                    collectGarbage(thread_id, Table[task.key_], low_watermark, batch_num);
+                    Table[task.key_].addPlaceholder(trans.timestamp_, cc_arenas[thread_id]);
+                    trans.addWrite(task.key_);
+                    AllResult[thread_id].placeholder_cnt_++;
                 }
             }
 
-            // Add to Ready Queue
-            {
-                std::lock_guard<std::mutex> lock(partition_mutex);
-                ready_queue.push(trans);
-            }
-
             // Update Results if the Transaction is Successfully Processed
             if (is_success) {
                 AllResult[thread_id].commit_cnt_++;  // Increment the Number of Committed Transactions
+                AllResult[thread_id].end_to_end_.record(nowNanos() - trans.arrival_ns_);
             }
         }
 
-        // Notify the Execution Worker
-        ready_queue_cv.notify_all();
+        cc_watermark.exit(thread_id);
+        AllResult[thread_id].cc_phase_.record(nowNanos() - batch_start);
+        __atomic_add_fetch(&tx_counter, size, __ATOMIC_RELEASE);
     }
 }
 
@@ -77,8 +81,8 @@ void cc_worker(int thread_id, const bool& start, const bool& quit) {
 // void debugRecordDistribution(size_t cc_thread_num) {
     // for (size_t thread_id = 0; thread_id < cc_thread_num; ++thread_id) {
         // std::cout << "[DEBUG] CC Thread " << thread_id << " assigned records: ";
-        // for (const auto& record : thread_partitions[thread_id]) {
-        //     std::cout << record << " ";
+        // for (uint64_t record = 0; record < partitioner.tupleNum(); ++record) {
+        //     if (partitioner.owns(thread_id, record)) std::cout << record << " ";
         // }
         // std::cout << std::endl;
     // }
@@ -0,0 +1,91 @@
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Bounded Multi-Producer Multi-Consumer Queue (Vyukov)
+// Every cell carries a sequence number that tells producers and consumers
+// whose turn it is, so each side only contends on its own cursor.
+template <typename T>
+class alignas(64) BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity = 1) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        cells_ = std::vector<Cell>(size);
+        for (size_t i = 0; i < size; ++i) cells_[i].sequence_ = i;
+        mask_ = size - 1;
+    }
+
+    // False if the queue is full; value is left untouched in that case
+    bool tryPush(T& value) {
+        uint64_t position = __atomic_load_n(&enqueue_, __ATOMIC_RELAXED);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[position & mask_];
+            uint64_t sequence = __atomic_load_n(&cell->sequence_, __ATOMIC_ACQUIRE);
+            int64_t diff = static_cast<int64_t>(sequence - position);
+            if (diff == 0) {
+                if (__atomic_compare_exchange_n(&enqueue_, &position, position + 1, true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = __atomic_load_n(&enqueue_, __ATOMIC_RELAXED);
+            }
+        }
+        cell->value_ = std::move(value);
+        __atomic_store_n(&cell->sequence_, position + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // False if the queue is empty
+    bool tryPop(T& value) {
+        uint64_t position = __atomic_load_n(&dequeue_, __ATOMIC_RELAXED);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[position & mask_];
+            uint64_t sequence = __atomic_load_n(&cell->sequence_, __ATOMIC_ACQUIRE);
+            int64_t diff = static_cast<int64_t>(sequence - (position + 1));
+            if (diff == 0) {
+                if (__atomic_compare_exchange_n(&dequeue_, &position, position + 1, true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = __atomic_load_n(&dequeue_, __ATOMIC_RELAXED);
+            }
+        }
+        value = std::move(cell->value_);
+        __atomic_store_n(&cell->sequence_, position + mask_ + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Exact Once Producers Have Stopped
+    bool empty() const {
+        return __atomic_load_n(&dequeue_, __ATOMIC_ACQUIRE) >=
+               __atomic_load_n(&enqueue_, __ATOMIC_ACQUIRE);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        uint64_t sequence_ = 0;
+        T value_{};
+    };
+
+    std::vector<Cell> cells_;
+    size_t mask_ = 0;
+    alignas(64) uint64_t enqueue_ = 0;
+    alignas(64) uint64_t dequeue_ = 0;
+};
+
+#endif // BOUNDED_QUEUE_HPP
@@ -0,0 +1,270 @@
+#ifndef COMMAND_LOG_HPP
+#define COMMAND_LOG_HPP
+
+#include "metrics.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// When Logged Batches Count as Durable
+enum class LogSync {
+    OFF,     // No Log
+    WRITE,   // Once Written to the OS, Without fsync
+    BATCH,   // fsync Whenever the Writer Has Something New (Group Commit of What Piled Up)
+    WINDOW,  // At Most One fsync per Window, Covering Every Batch Written Before It
+};
+
+inline LogSync parseLogSync(const std::string& name) {
+    if (name == "off") return LogSync::OFF;
+    if (name == "write") return LogSync::WRITE;
+    if (name == "batch") return LogSync::BATCH;
+    if (name == "window") return LogSync::WINDOW;
+    throw std::invalid_argument("unknown log sync mode: " + name);
+}
+
+inline const char* logSyncName(LogSync sync) {
+    switch (sync) {
+    case LogSync::OFF: return "off";
+    case LogSync::WRITE: return "write";
+    case LogSync::BATCH: return "batch";
+    case LogSync::WINDOW: return "window";
+    }
+    return "unknown";
+}
+
+// On-Disk Batch Record: This Header, Then word_num_ 64-Bit Words. Each
+// Transaction Is a Descriptor Word (logTransaction), Then per Task Its Key
+// and, for a Range Scan, the Range Length in One More Word.
+// Only Inputs Are Logged: Replaying Them in Timestamp Order Rebuilds the State.
+struct LogBatchHeader {
+    static constexpr uint64_t MAGIC = 0x32474f4c4d484f42ULL; // "BOHMLOG2"
+
+    uint64_t magic_;
+    uint64_t batch_id_;
+    uint64_t first_timestamp_;
+    uint32_t txn_num_;
+    uint32_t word_num_;
+    uint64_t checksum_;        // Of the Words
+};
+
+// Descriptor: Task Count in the Low Byte, Then Two Bits per Task for Its
+// Operation (the Protocol's Own Numbering), So Keys Keep All 64 Bits
+inline uint64_t logTransaction(size_t task_num) { return task_num; }
+inline void logOperation(uint64_t& descriptor, size_t task, unsigned operation) {
+    descriptor |= static_cast<uint64_t>(operation) << (8 + 2 * task);
+}
+inline size_t loggedTaskNum(uint64_t descriptor) { return descriptor & 0xff; }
+inline unsigned loggedOperation(uint64_t descriptor, size_t task) {
+    return descriptor >> (8 + 2 * task) & 3;
+}
+
+inline uint64_t logChecksum(const uint64_t* words, size_t word_num) {
+    uint64_t checksum = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < word_num; ++i) checksum = (checksum ^ words[i]) * 0x100000001b3ULL;
+    return checksum;
+}
+
+// I/O Done by the Writer Thread During One Run
+struct LogStats {
+    uint64_t batches_ = 0;
+    uint64_t bytes_ = 0;
+    uint64_t syncs_ = 0;
+};
+
+// Command Log: Append-Only File of Sequenced Batches
+// The sequencer appends each batch to an in-memory group; a writer thread
+// swaps the group out, writes it and syncs it according to the mode, then
+// reports how many batches (in id order) are durable. No worker thread ever
+// waits on the file itself. A failed write or sync is not thrown on the
+// writer thread: the writer keeps its errno, reports nothing durable from
+// then on and drops whatever is appended, and the run checks error().
+class CommandLog {
+public:
+    CommandLog() = default;
+    CommandLog(const CommandLog&) = delete;
+    CommandLog& operator=(const CommandLog&) = delete;
+    ~CommandLog() { close(); }
+
+    // Truncates path and starts the writer; durable(n) is called from the
+    // writer whenever batches 0 .. n-1 become durable
+    void open(const std::string& path, LogSync sync, uint64_t window_us,
+              std::function<void(uint64_t)> durable) {
+        close();
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) throw std::system_error(errno, std::generic_category(), "cannot open log " + path);
+        sync_ = sync;
+        window_ns_ = window_us * 1000;
+        durable_ = std::move(durable);
+        pending_.clear();
+        appended_ = 0;
+        closing_ = false;
+        error_ = 0;
+        failed_call_ = "";
+        stats_ = LogStats();
+        writer_ = std::thread([this] { writerLoop(); });
+    }
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Sequencer: queues one batch; batches must be appended in id order
+    void append(uint64_t batch_id, uint64_t first_timestamp, uint32_t txn_num,
+                const std::vector<uint64_t>& words) {
+        LogBatchHeader header{LogBatchHeader::MAGIC, batch_id, first_timestamp, txn_num,
+                              static_cast<uint32_t>(words.size()),
+                              logChecksum(words.data(), words.size())};
+        const char* body = reinterpret_cast<const char*>(words.data());
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const char* head = reinterpret_cast<const char*>(&header);
+            pending_.insert(pending_.end(), head, head + sizeof(header));
+            pending_.insert(pending_.end(), body, body + words.size() * sizeof(uint64_t));
+            appended_ = batch_id + 1;
+        }
+        wakeup_.notify_one();
+    }
+
+    // Writes and syncs whatever is queued, then stops the writer
+    void close() {
+        if (fd_ < 0) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        wakeup_.notify_one();
+        writer_.join();
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    // Valid once the log is closed
+    const LogStats& stats() const { return stats_; }
+
+    // errno of the first failed write or sync, 0 if none, and the call that failed
+    int error() const { return __atomic_load_n(&error_, __ATOMIC_ACQUIRE); }
+    const char* failedCall() const { return failed_call_; }
+
+private:
+    void writerLoop() {
+        std::vector<char> group;
+        uint64_t written = 0;   // Batches in the file
+        uint64_t durable = 0;   // Batches reported durable
+        uint64_t last_sync_ns = nowNanos();
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            auto ready = [this] { return !pending_.empty() || closing_; };
+            if (sync_ == LogSync::WINDOW && written > durable) {
+                uint64_t now = nowNanos();
+                uint64_t deadline = last_sync_ns + window_ns_;
+                if (now < deadline) wakeup_.wait_for(lock, std::chrono::nanoseconds(deadline - now), ready);
+            } else {
+                wakeup_.wait(lock, ready);
+            }
+            bool closing = closing_;
+            group.swap(pending_);
+            uint64_t appended = appended_;
+            lock.unlock();
+
+            if (!group.empty() && !error()) {
+                if (writeAll(group)) {
+                    stats_.bytes_ += group.size();
+                    stats_.batches_ += appended - written;
+                    written = appended;
+                }
+            }
+            group.clear();
+            bool sync = written > durable && sync_ != LogSync::WRITE && !error() &&
+                        (sync_ == LogSync::BATCH || closing || nowNanos() >= last_sync_ns + window_ns_);
+            if (sync) {
+                if (fdatasync(fd_) == 0) {
+                    stats_.syncs_++;
+                    last_sync_ns = nowNanos();
+                } else {
+                    fail(errno, "log fdatasync");
+                }
+            }
+            if ((sync || sync_ == LogSync::WRITE) && written > durable && !error()) {
+                durable = written;
+                durable_(durable);
+            }
+
+            lock.lock();
+            if (closing && pending_.empty()) return;
+        }
+    }
+
+    // False if the write failed
+    bool writeAll(const std::vector<char>& data) {
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = ::write(fd_, data.data() + done, data.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                fail(errno, "log write");
+                return false;
+            }
+            done += n;
+        }
+        return true;
+    }
+
+    void fail(int error, const char* call) {
+        failed_call_ = call;
+        __atomic_store_n(&error_, error, __ATOMIC_RELEASE);
+    }
+
+    int fd_ = -1;
+    LogSync sync_ = LogSync::BATCH;
+    uint64_t window_ns_ = 0;
+    std::function<void(uint64_t)> durable_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::vector<char> pending_;   // Group Being Filled by the Sequencer
+    uint64_t appended_ = 0;       // Batches Queued So Far
+    bool closing_ = false;
+    int error_ = 0;                   // Set by the Writer, Read by the Run
+    const char* failed_call_ = "";
+    std::thread writer_;
+    LogStats stats_;
+};
+
+// One Batch Read Back From the Log
+struct LoggedBatch {
+    uint64_t batch_id_;
+    uint64_t first_timestamp_;
+    uint32_t txn_num_;
+    std::vector<uint64_t> words_;
+};
+
+// Reads Every Complete Batch of a Log, Starting at Batch 0. A Torn or
+// Corrupt Record, e.g. the Tail Being Written at a Crash, Ends the Log.
+inline std::vector<LoggedBatch> readCommandLog(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("cannot open log " + path);
+    std::vector<LoggedBatch> batches;
+    LogBatchHeader header;
+    while (file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        if (header.magic_ != LogBatchHeader::MAGIC || header.batch_id_ != batches.size()) break;
+        LoggedBatch batch{header.batch_id_, header.first_timestamp_, header.txn_num_,
+                          std::vector<uint64_t>(header.word_num_)};
+        if (!file.read(reinterpret_cast<char*>(batch.words_.data()), header.word_num_ * sizeof(uint64_t)) ||
+            logChecksum(batch.words_.data(), batch.words_.size()) != header.checksum_) {
+            break;
+        }
+        batches.push_back(std::move(batch));
+    }
+    return batches;
+}
+
+#endif // COMMAND_LOG_HPP
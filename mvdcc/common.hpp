@@ -2,6 +2,12 @@
 #define COMMON_HPP
 
 #include "config.hpp"
+#include "tuple.hpp"
+#include "partitioner.hpp"
+#include "metrics.hpp"
+#include "numa.hpp"
+#include "workload.hpp"
+#include "txn_source.hpp"
 #include <vector>
 #include <queue>
 #include <cstdint>
@@ -12,12 +18,6 @@
 #include <iostream>
 #include <algorithm>
 
-// Result Class: Store Transaction Results Per Thread
-class Result {
-public:
-    uint64_t commit_cnt_ = 0; // Number of Committed Transactions
-};
-
 // Task Class: Define Transaction Tasks
 enum class Ope { READ, WRITE };
 
@@ -27,112 +27,164 @@ public:
     uint64_t key_;
 
     Task(Ope ope, uint64_t key) : ope_(ope), key_(key) {}
+    Task() : ope_(Ope::READ), key_(0) {}
 };
 
 // Transaction Class: Transaction Data
+// Fixed Size, Bounded by MAX_OPE, So It Moves Through the Client Queue and
+// the CC Batches Without Heap Allocation
 class Transaction {
 public:
     uint64_t timestamp_;
-    std::vector<std::pair<uint64_t, uint64_t>> read_set_;
-    std::vector<uint64_t> write_set_;
-    std::vector<Task> task_set_; // Task Ope List
+    uint64_t arrival_ns_ = 0; // Intended Arrival at the Client
+    uint32_t task_num_ = 0;
+    uint32_t write_num_ = 0;
+    Task task_set_[MAX_OPE];      // Task Ope List
+    uint64_t write_set_[MAX_OPE]; // Keys With a Placeholder Installed
 
     Transaction(uint64_t timestamp) : timestamp_(timestamp) {}
     Transaction() : timestamp_(0) {}
+
+    void addWrite(uint64_t key) { write_set_[write_num_++] = key; }
 };
 
-// Tuple Class: Records in the Database
-class Tuple {
+// Global Variable Definition
+extern Tuple* Table;
+extern PageArray<Tuple> table_pages;        // Backs Table
+extern PageArray<char> image_pages;         // Initial Record Images
+extern TransactionSource<Transaction> txn_source; // Client Stream Feeding the CC Threads
+extern uint64_t tx_counter;                 // Transactions Through the CC Phase
+extern size_t batch_size;                   // Transactions per CC Batch
+extern uint64_t batch_timeout_ns;           // Partial Batches Are Cut After This Long
+extern Partitioner partitioner;
+extern std::vector<VersionArena> cc_arenas; // Per-CC-Thread Version Arenas
+
+// Low Watermark of the CC-Only Protocols: the Oldest Timestamp of Any Batch in
+// the CC Phase. These Protocols Have No Readers and No Execution Phase, So a
+// Version That Ended Before It Is Needed by No Running Transaction; the
+// Transactions Still in the Client Queue Never Read Versions Either.
+class CCWatermark {
 public:
-    struct Version {
-        uint64_t begin_timestamp_;
-        uint64_t end_timestamp_;
-        uint64_t value_;
-        bool placeholder_;
-        Version* prev_pointer_;
-
-        Version(uint64_t begin, uint64_t end, uint64_t value, bool placeholder, Version* prev)
-            : begin_timestamp_(begin), end_timestamp_(end), value_(value),
-              placeholder_(placeholder), prev_pointer_(prev) {}
-    };
+    void init(size_t thread_num) { slots_ = std::vector<Slot>(thread_num); }
 
-    Version* latest_version_;
+    // A CC Thread Starts a Batch Whose Oldest Transaction Has oldest_timestamp
+    void enter(size_t thread_id, uint64_t oldest_timestamp) {
+        __atomic_store_n(&slots_[thread_id].timestamp_, oldest_timestamp, __ATOMIC_SEQ_CST);
+    }
 
-    Tuple() {
-        latest_version_ = new Version(0, UINT64_MAX, 0, false, nullptr);
+    void exit(size_t thread_id) {
+        __atomic_store_n(&slots_[thread_id].timestamp_, IDLE, __ATOMIC_RELEASE);
     }
 
-    void addPlaceholder(uint64_t timestamp) {
-        auto new_version = new Version(timestamp, UINT64_MAX, 0, true, latest_version_);
-        if (latest_version_) {
-            latest_version_->end_timestamp_ = timestamp;
+    uint64_t low() const {
+        uint64_t low = IDLE;
+        for (const Slot& slot : slots_) {
+            low = std::min(low, __atomic_load_n(&slot.timestamp_, __ATOMIC_SEQ_CST));
         }
-        latest_version_ = new_version;
+        return low;
     }
 
-    bool updatePlaceholder(uint64_t timestamp, uint64_t value) {
-        Version* version = latest_version_;
-        while (version) {
-            if (version->begin_timestamp_ == timestamp && version->placeholder_) {
-                version->value_ = value;
-                version->placeholder_ = false;
-                return true;
-            }
-            version = version->prev_pointer_;
+private:
+    static constexpr uint64_t IDLE = UINT64_MAX;
+
+    struct alignas(64) Slot {
+        uint64_t timestamp_ = IDLE;
+    };
+
+    std::vector<Slot> slots_;
+};
+
+extern CCWatermark cc_watermark;
+
+// Common Function Definition
+// Initializes the Table in Fresh Pages; Each Tuple Refers to Its Initial
+// Image (payload_size Zero Bytes) in a Second Array. With a Pinned Placement
+// Every CC Thread First-Touches the Records the Partitioner Gives It, Images
+// Included, So They End Up on Its Node; It Enumerates Them Directly Where the
+// Partition Allows, Otherwise They Are Grouped by Owner First. Without One the
+// CC Threads Load One Contiguous Chunk Each.
+void makeDB(size_t tuple_num, size_t payload_size, const ThreadPlacement& placement, bool huge_pages) {
+    Table = table_pages.allocate(tuple_num, huge_pages);
+    char* images = image_pages.allocate(tuple_num * payload_size, huge_pages);
+    auto load = [images, payload_size](uint64_t key) {
+        char* image = images + key * payload_size;
+        std::fill(image, image + payload_size, 0);
+        new (&Table[key]) Tuple(image, static_cast<uint32_t>(payload_size));
+    };
+    if (placement.pinned()) {
+        if (partitioner.enumerable()) {
+            runPinned(placement, partitioner.threadNum(), [tuple_num, &load](size_t thread_id) {
+                partitioner.forEachOwned(thread_id, tuple_num, load);
+            });
+            return;
         }
-        return false;
+        OwnerGroups groups = groupByOwner(tuple_num, partitioner.threadNum(), partitioner.threadNum(),
+                                          [](uint64_t key) { return partitioner.owner(key); });
+        runPinned(placement, partitioner.threadNum(), [&groups, &load](size_t thread_id) {
+            for (uint64_t key : groups.group(thread_id)) load(key);
+        });
+        return;
     }
+    parallelFor(tuple_num, partitioner.threadNum(), [&load](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) load(i);
+    });
+}
 
-    std::optional<uint64_t> getVersion(uint64_t timestamp) {
-        Version* version = latest_version_;
-        while (version) {
-            if (version->begin_timestamp_ <= timestamp && timestamp < version->end_timestamp_ && !version->placeholder_) {
-                return version->value_;
-            }
-            version = version->prev_pointer_;
-        }
-        return std::nullopt;
+// Versions Carry Their Image Behind Them, So Every Slot Holds payload_size More Bytes
+void initializeArenas(size_t cc_thread_num, size_t payload_size) {
+    cc_arenas.clear();
+    cc_arenas.reserve(cc_thread_num);
+    for (size_t i = 0; i < cc_thread_num; ++i) {
+        cc_arenas.emplace_back(ARENA_SLAB_SIZE, Tuple::versionSize(payload_size));
     }
-};
+}
 
-// Global Variable Definition
-extern std::vector<Tuple> Table;
-extern std::vector<Transaction> transactions;
-extern std::priority_queue<Transaction, std::vector<Transaction>, 
-                           std::function<bool(const Transaction&, const Transaction&)>> ready_queue;
-extern uint64_t tx_counter;
-extern std::vector<std::vector<uint64_t>> thread_partitions;
-extern std::mutex partition_mutex;
-extern std::condition_variable ready_queue_cv;
+// Unlinks the Versions of a Record That Ended Before low_watermark and Retires
+// Them to thread_id's Arena Under Its Batch Number. Only a Record's Owner Walks
+// Its Chain, and Ownership Changes Only Between Batches, So They Can Be
+// Recycled Once the Owner Has Moved On to Its Next Batch.
+void collectGarbage(int thread_id, Tuple& tuple, uint64_t low_watermark, uint64_t batch_num) {
+    Tuple::Version* version = tuple.pruneVersions(low_watermark);
+    while (version) {
+        Tuple::Version* prev = version->prev_pointer_;
+        cc_arenas[thread_id].retire(version, batch_num);
+        version = prev;
+    }
+}
 
-// Common Function Definition
-void makeDB(size_t tuple_num) {
-    Table.resize(tuple_num);
-    for (size_t i = 0; i < tuple_num; ++i) {
-        Table[i] = Tuple();
+// Fills One Transaction of the Client Stream
+void makeTransaction(const WorkloadConfig& workload, const KeyGenerator& keys, FastRandom& rng,
+                     uint64_t timestamp, uint64_t arrival_ns, Transaction& trans) {
+    WorkloadOp ops[MAX_OPE];
+    size_t task_num = generateOps(workload, keys, rng, ops);
+    trans.timestamp_ = timestamp;
+    trans.arrival_ns_ = arrival_ns;
+    trans.task_num_ = task_num;
+    trans.write_num_ = 0;
+    for (size_t j = 0; j < task_num; ++j) {
+        trans.task_set_[j] = Task(ops[j].write ? Ope::WRITE : Ope::READ, ops[j].key);
     }
 }
 
-void initializeTransactions(size_t tuple_num, double read_ratio) {
-    transactions.resize(tuple_num);
-    for (uint64_t i = 0; i < tuple_num; ++i) {
-        transactions[i] = Transaction(i);
-        transactions[i].task_set_.clear(); // Initialize
-
-        size_t task_num = 10; 
-        for (size_t j = 0; j < task_num; ++j) {
-            double rand_value = static_cast<double>(rand()) / RAND_MAX; // 0.0 ~ 1.0 
-            uint64_t random_key = rand() % tuple_num; // 0 ~ tuple_num-1
-
-            if (rand_value < read_ratio) {
-                // Read
-                transactions[i].task_set_.emplace_back(Ope::READ, random_key);
-            } else {
-                // Write
-                transactions[i].task_set_.emplace_back(Ope::WRITE, random_key);
-            }
+// Takes the Next Batch Off the Client Queue: batch_size Transactions, or Fewer
+// Once batch_timeout_ns Has Passed Since the First One. Transactions Are
+// Popped Straight Into batch, Which Holds batch_size Entries and Is Reused
+// Across Batches. Returns the Batch Size; 0 on Quit or When the Source Is Exhausted.
+size_t fetchBatch(Transaction* batch, const bool& quit) {
+    size_t size = 0;
+    uint64_t deadline = UINT64_MAX;
+    while (size < batch_size) {
+        if (txn_source.pop(batch[size])) {
+            if (size++ == 0) deadline = nowNanos() + batch_timeout_ns;
+            continue;
+        }
+        if (__atomic_load_n(&quit, __ATOMIC_SEQ_CST) || txn_source.exhausted() ||
+            nowNanos() >= deadline) {
+            break;
         }
+        std::this_thread::yield();
     }
+    return size;
 }
 
 #endif // COMMON_HPP
@@ -2,11 +2,20 @@
 #define CONFIG_HPP
 
 #define PAGE_SIZE 4096
-#define DEFAULT_THREAD_NUM 64      // Default number of threads for debugging
-#define DEFAULT_TUPLE_NUM 1000000  // Default number of records for debugging
+#define DEFAULT_THREAD_NUM 64      // Default of bench --threads
+#define DEFAULT_TUPLE_NUM 1000000  // Default of bench --tuples
+#define DEFAULT_PAYLOAD_SIZE 8     // Default of bench --payload (bytes per record image)
 #define MAX_OPE 10                 // Maximum operations per transaction
-#define EX_TIME 3                  // Execution time in seconds
-#define BATCH_SIZE 200              // Reduced batch size for debugging
+#define EX_TIME 3                  // Default of bench --duration (seconds)
+#define BATCH_SIZE 200             // Default of bench --batch
+#define BATCH_TIMEOUT_US 200       // Default of bench --batch-timeout-us
+#define SOURCE_QUEUE_SIZE 65536    // Default of bench --queue
+#define LOG_WINDOW_US 1000         // Default of bench --log-window-us
+#define CHECKPOINT_INTERVAL_MS 1000 // Default of bench --checkpoint-ms
 #define MAX_RETRY 10               // Max retries for failed transactions
+#define MIGRATION_RANGE_SIZE 1024  // Records per Gato migration unit
+#define HEAT_SAMPLE_RATE 16        // Gato samples one of every N record accesses
+#define HOT_RANGE_THRESHOLD 8      // Sampled hits between hot-range reports
+#define HOT_LIST_SIZE 64           // Hot-range candidates kept per thread
 
 #endif // CONFIG_HPP
@@ -2,29 +2,177 @@
 #define GATO_CC_HPP
 
 #include "common.hpp"
-#include <unordered_map>
 #include <vector>
 #include <atomic>
 #include <mutex>
+#include <cstdlib>
+#include <new>
 #include <iostream>
 #include <algorithm>
+#include <functional>
+#include <utility>
+
+// Record Map: Flat, Cache-Aligned Array of Atomic Thread IDs Indexed by Key
+// Reads never lock; migrations change an entry with a single CAS.
+class RecordMap {
+public:
+    RecordMap() = default;
+    RecordMap(const RecordMap&) = delete;
+    RecordMap& operator=(const RecordMap&) = delete;
+    ~RecordMap() { free(slots_); }
+
+    void init(size_t record_num, int32_t initial) {
+        free(slots_);
+        slots_ = nullptr;
+        size_ = record_num;
+        if (posix_memalign(reinterpret_cast<void**>(&slots_), 64,
+                           std::max<size_t>(record_num, 1) * sizeof(int32_t)) != 0) {
+            throw std::bad_alloc();
+        }
+        for (size_t i = 0; i < record_num; ++i) slots_[i] = initial;
+    }
+
+    bool contains(uint64_t key) const { return key < size_; }
+    size_t size() const { return size_; }
+
+    int32_t load(uint64_t key) const {
+        return __atomic_load_n(&slots_[key], __ATOMIC_ACQUIRE);
+    }
+
+    void store(uint64_t key, int32_t thread_id) {
+        __atomic_store_n(&slots_[key], thread_id, __ATOMIC_RELEASE);
+    }
+
+    // Moves a Record Only if It Is Still Owned by expected
+    bool migrate(uint64_t key, int32_t expected, int32_t desired) {
+        return __atomic_compare_exchange_n(&slots_[key], &expected, desired, false,
+                                           __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+
+private:
+    int32_t* slots_ = nullptr;
+    size_t size_ = 0;
+};
+
+// A Migrated Record Changes Hands at Batch Boundaries: the Giving Thread Marks
+// It in Transit to the Receiver Between Two of Its Batches, and the Receiver
+// Takes It Over Between Two of Its Own, So Neither Sees the Records It Owns
+// Change Within a Batch. A Record in Transit Has No Owner.
+inline int32_t inTransit(int32_t receiver) { return -2 - receiver; }
+
+// Thread a Record Is Owned by or in Transit To
+inline int32_t destination(int32_t owner) { return owner < -1 ? -2 - owner : owner; }
+
+// Migration Inbox: Ranges in Transit to Each Thread, Posted by the Giving Threads
+class MigrationInbox {
+public:
+    void init(size_t thread_num) { boxes_ = std::vector<Box>(thread_num); }
+
+    void post(int receiver, uint64_t range) {
+        Box& box = boxes_[receiver];
+        std::lock_guard<std::mutex> lock(box.mutex_);
+        box.ranges_.push_back(range);
+        __atomic_store_n(&box.pending_, true, __ATOMIC_RELEASE);
+    }
+
+    // Moves the Ranges Posted to receiver Into ranges; Locks Only if There Are Any
+    void take(int receiver, std::vector<uint64_t>& ranges) {
+        ranges.clear();
+        Box& box = boxes_[receiver];
+        if (!__atomic_load_n(&box.pending_, __ATOMIC_ACQUIRE)) return;
+        std::lock_guard<std::mutex> lock(box.mutex_);
+        ranges.swap(box.ranges_);
+        __atomic_store_n(&box.pending_, false, __ATOMIC_RELAXED);
+    }
+
+private:
+    struct alignas(64) Box {
+        std::mutex mutex_;
+        std::vector<uint64_t> ranges_;
+        bool pending_ = false;
+    };
+
+    std::vector<Box> boxes_;
+};
+
+// Heat Tracker: Sampled Per-Record and Per-Range Access Counters
+// Every HOT_RANGE_THRESHOLD sampled hits a range is reported to its owner's
+// bounded candidate list, so finding hot ranges never scans the table.
+class HeatTracker {
+public:
+    void init(size_t record_num, size_t thread_num) {
+        record_heat_.assign(record_num, 0);
+        range_heat_.assign((record_num + MIGRATION_RANGE_SIZE - 1) / MIGRATION_RANGE_SIZE, 0);
+        candidates_ = std::vector<Candidates>(thread_num);
+    }
+
+    // Called for a Sampled Access by Any Thread; owner Is the Record's Current Owner
+    void sample(uint64_t key, int owner) {
+        __atomic_add_fetch(&record_heat_[key], 1, __ATOMIC_RELAXED);
+        uint64_t range = key / MIGRATION_RANGE_SIZE;
+        if (__atomic_add_fetch(&range_heat_[range], 1, __ATOMIC_RELAXED) % HOT_RANGE_THRESHOLD == 0) {
+            Candidates& list = candidates_[owner];
+            uint64_t slot = __atomic_fetch_add(&list.head_, 1, __ATOMIC_RELAXED) % HOT_LIST_SIZE;
+            __atomic_store_n(&list.ranges_[slot], range + 1, __ATOMIC_RELAXED); // 0 Marks Empty
+        }
+    }
+
+    // Recently Reported Ranges of a Thread, Hottest First, Called Once per
+    // Migration Round. Heat Is Read Once per Range and Sorted as a Copy, Since
+    // Other Threads Keep Raising It. Each Round Then Halves the Heat of the
+    // Ranges It Saw, So a Range That Cooled Down Drops Behind Those Hot Now.
+    std::vector<uint64_t> hotRanges(int thread_id) {
+        std::vector<std::pair<uint32_t, uint64_t>> heats; // (Heat, Range)
+        for (auto& entry : candidates_[thread_id].ranges_) {
+            uint64_t range = __atomic_exchange_n(&entry, 0, __ATOMIC_RELAXED);
+            if (range != 0) heats.emplace_back(0, range - 1);
+        }
+        std::sort(heats.begin(), heats.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+        heats.erase(std::unique(heats.begin(), heats.end()), heats.end());
+        for (auto& [heat, range] : heats) {
+            heat = rangeHeat(range);
+            __atomic_sub_fetch(&range_heat_[range], heat / 2, __ATOMIC_RELAXED); // Keeps Concurrent Hits
+        }
+        std::sort(heats.begin(), heats.end(), std::greater<>());
+        std::vector<uint64_t> ranges;
+        ranges.reserve(heats.size());
+        for (const auto& [heat, range] : heats) ranges.push_back(range);
+        return ranges;
+    }
+
+    uint32_t recordHeat(uint64_t key) const { return __atomic_load_n(&record_heat_[key], __ATOMIC_RELAXED); }
+    uint32_t rangeHeat(uint64_t range) const { return __atomic_load_n(&range_heat_[range], __ATOMIC_RELAXED); }
+
+private:
+    struct alignas(64) Candidates {
+        uint64_t head_ = 0;
+        uint64_t ranges_[HOT_LIST_SIZE] = {};
+    };
+
+    std::vector<uint32_t> record_heat_;
+    std::vector<uint32_t> range_heat_;
+    std::vector<Candidates> candidates_;
+};
 
 // Global Variable Declaration (Using the extern Keyword)
-extern std::vector<Result> AllResult; // Store Performance Results per Thread
-extern std::unordered_map<uint64_t, int> record_to_thread; // Record-to-Thread Mapping
-extern std::vector<int> thread_load;                       // Load of Each Thread
-extern std::unordered_map<uint64_t, int> last_writer;      // Last Writing Thread of a Record
-extern std::mutex mapping_mutex;                           // Synchronize Mapping Table
+extern std::vector<Result> AllResult;    // Store Performance Results per Thread
+extern RecordMap record_to_thread;       // Record-to-Thread Mapping
+extern std::vector<int64_t> thread_load; // Sampled Accesses to Each Thread's Records
+extern RecordMap last_writer;            // Last Writing Thread of a Record
+extern HeatTracker heat_tracker;         // Access Heat for Load Balancing
+extern MigrationInbox migration_inbox;   // Ranges in Transit Between Threads
 
 // Static Partitioning
-void assignRecordsToThreads(size_t cc_thread_num, size_t tuple_num) {
-    thread_partitions.resize(cc_thread_num);
-    record_to_thread.clear(); // Initialize record_to_thread
+void assignRecordsToThreads(size_t cc_thread_num, size_t tuple_num,
+                            PartitionStrategy strategy = PartitionStrategy::MODULO) {
+    partitioner.build(strategy, cc_thread_num, tuple_num);
+    record_to_thread.init(tuple_num, 0); // Initialize record_to_thread
+    last_writer.init(tuple_num, -1);
+    heat_tracker.init(tuple_num, cc_thread_num);
+    migration_inbox.init(cc_thread_num);
 
     for (uint64_t i = 0; i < tuple_num; ++i) {
-        size_t thread_id = i % cc_thread_num;
-        thread_partitions[thread_id].push_back(i);
-        record_to_thread[i] = thread_id; // Initialize Mapping Table
+        record_to_thread.store(i, partitioner.owner(i)); // Initialize Mapping Table
     }
 
     // Debug: Check Initialization Status
@@ -35,98 +183,144 @@ void assignRecordsToThreads(size_t cc_thread_num, size_t tuple_num) {
 
 // Debug: Print Load Status per Thread
 // void debugThreadLoad() {
-//     std::lock_guard<std::mutex> lock(mapping_mutex);
 //     for (size_t i = 0; i < thread_load.size(); ++i) {
 //         std::cout << "[DEBUG] Thread " << i << " load: " << thread_load[i] << std::endl;
 //     }
 // }
 
-// Load Redistribution Function
+// Load Redistribution Function: Hands the Hottest Ranges of overloaded_thread
+// to underloaded_thread in Bulk Until About Half the Load Gap Has Moved.
+// Only the overloaded thread calls this, between two of its batches; the
+// ranges stay in transit until underloaded_thread takes them over between
+// two of its own (acceptMigrations).
+// Cost Is O(Hot-List Size + Migrated Ranges), Independent of the Table Size.
 void redistributeLoad(int overloaded_thread, int underloaded_thread) {
-    std::lock_guard<std::mutex> lock(mapping_mutex);
-
     // Validate Threads
-    if (overloaded_thread < 0 || overloaded_thread >= thread_load.size() ||
-        underloaded_thread < 0 || underloaded_thread >= thread_load.size()) {
+    if (overloaded_thread < 0 || overloaded_thread >= static_cast<int>(thread_load.size()) ||
+        underloaded_thread < 0 || underloaded_thread >= static_cast<int>(thread_load.size()) ||
+        overloaded_thread == underloaded_thread) {
         // std::cerr << "[ERROR] Invalid thread IDs in redistributeLoad." << std::endl;
         return;
     }
 
-    for (auto& [record, thread_id] : record_to_thread) {
-        if (thread_id == overloaded_thread) {
-            record_to_thread[record] = underloaded_thread;
-            thread_load[overloaded_thread]--;
-            thread_load[underloaded_thread]++;
-            // std::cout << "[DEBUG] Moved Record " << record << " from Thread "
-            //           << overloaded_thread << " to Thread " << underloaded_thread << std::endl;
-            return; // Move Only One Record at a Time
+    int64_t target = (__atomic_load_n(&thread_load[overloaded_thread], __ATOMIC_RELAXED) -
+                      __atomic_load_n(&thread_load[underloaded_thread], __ATOMIC_RELAXED)) / 2;
+    int64_t moved = 0;
+
+    for (uint64_t range : heat_tracker.hotRanges(overloaded_thread)) {
+        if (moved >= target) break;
+        uint64_t first = range * MIGRATION_RANGE_SIZE;
+        uint64_t last = std::min(first + MIGRATION_RANGE_SIZE, (uint64_t)record_to_thread.size());
+        bool any = false;
+        for (uint64_t record = first; record < last; ++record) {
+            if (record_to_thread.migrate(record, overloaded_thread, inTransit(underloaded_thread))) {
+                moved += heat_tracker.recordHeat(record);
+                any = true;
+            }
+        }
+        if (any) migration_inbox.post(underloaded_thread, range);
+        // std::cout << "[DEBUG] Moved Range " << range << " from Thread "
+        //           << overloaded_thread << " to Thread " << underloaded_thread << std::endl;
+    }
+
+    __atomic_sub_fetch(&thread_load[overloaded_thread], moved, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&thread_load[underloaded_thread], moved, __ATOMIC_RELAXED);
+}
+
+// Takes Over the Records in Transit to thread_id; Called Between Two of Its Batches
+void acceptMigrations(int thread_id, std::vector<uint64_t>& ranges) {
+    migration_inbox.take(thread_id, ranges);
+    for (uint64_t range : ranges) {
+        uint64_t first = range * MIGRATION_RANGE_SIZE;
+        uint64_t last = std::min(first + MIGRATION_RANGE_SIZE, (uint64_t)record_to_thread.size());
+        for (uint64_t record = first; record < last; ++record) {
+            record_to_thread.migrate(record, inTransit(thread_id), thread_id);
         }
     }
 }
 
 void gato_cc_worker(int thread_id, const bool& start, const bool& quit) {
     size_t iteration_count = 0; // Counter to Control Debugging Frequency
+    uint64_t access_count = 0;  // Drives Heat Sampling
+    uint64_t batch_num = 0;     // Batches Processed, the Epoch of Retired Versions
+
+    std::vector<Transaction> local_batch(batch_size); // Reused Across Batches
+    std::vector<uint64_t> accepted;                   // Ranges Taken Over at a Boundary
+    std::vector<int64_t> loads(thread_load.size());   // Snapshot of thread_load
 
     while (!__atomic_load_n(&start, __ATOMIC_SEQ_CST)) {}
 
     while (!__atomic_load_n(&quit, __ATOMIC_SEQ_CST)) {
-        std::vector<Transaction> local_batch;
-
         // Fetch Transaction Batch
-        uint64_t start_pos = __atomic_fetch_add(&tx_counter, BATCH_SIZE, __ATOMIC_SEQ_CST);
-        uint64_t end_pos = std::min(start_pos + BATCH_SIZE, (uint64_t)transactions.size());
-        for (uint64_t i = start_pos; i < end_pos; ++i) {
-            local_batch.emplace_back(transactions[i]);
+        size_t size = fetchBatch(local_batch.data(), quit);
+        acceptMigrations(thread_id, accepted);
+        uint64_t batch_start = nowNanos();
+        cc_arenas[thread_id].reclaim(batch_num++);
+        cc_arenas[thread_id].reserve(size * MAX_OPE);
+        uint64_t oldest = UINT64_MAX;
+        for (size_t position = 0; position < size; ++position) {
+            oldest = std::min(oldest, local_batch[position].timestamp_);
         }
+        cc_watermark.enter(thread_id, oldest);
+        uint64_t low_watermark = cc_watermark.low();
 
         // Execute CC phase
-        for (auto& trans : local_batch) {
+        for (size_t position = 0; position < size; ++position) {
+            Transaction& trans = local_batch[position];
             bool is_success = true;
 
-            for (const auto& task : trans.task_set_) {
-                {
-                    std::lock_guard<std::mutex> lock(mapping_mutex);
-                    if (record_to_thread.find(task.key_) == record_to_thread.end()) {
-                        is_success = false; // Handle Failure if Unmanaged Records Exist
-                        continue;
-                    }
-                    int assigned_thread = record_to_thread[task.key_];
-                    if (assigned_thread != thread_id) continue; // Skip if Not Managed by the Current Thread
+            for (uint32_t i = 0; i < trans.task_num_; ++i) {
+                const Task& task = trans.task_set_[i];
+                if (!record_to_thread.contains(task.key_)) {
+                    is_success = false; // Handle Failure if Unmanaged Records Exist
+                    continue;
+                }
+                int owner = record_to_thread.load(task.key_);
+                if (++access_count % HEAT_SAMPLE_RATE == 0) {
+                    heat_tracker.sample(task.key_, destination(owner));
+                    __atomic_add_fetch(&thread_load[destination(owner)], 1, __ATOMIC_RELAXED);
                 }
+                if (owner != thread_id) continue; // Skip if Not Managed by the Current Thread
 
                 if (task.ope_ == Ope::WRITE) {
-                    {
-                        std::lock_guard<std::mutex> lock(mapping_mutex);
-                        if (last_writer[task.key_] != thread_id) {
-                            last_writer[task.key_] = thread_id;
-                        }
+                    if (last_writer.load(task.key_) != thread_id) {
+                        last_writer.store(task.key_, thread_id);
                     }
-                    Table[task.key_].addPlaceholder(trans.timestamp_);
-                    trans.write_set_.emplace_back(task.key_);
+                    collectGarbage(thread_id, Table[task.key_], low_watermark, batch_num);
+                    Table[task.key_].addPlaceholder(trans.timestamp_, cc_arenas[thread_id]);
+                    trans.addWrite(task.key_);
+                    AllResult[thread_id].placeholder_cnt_++;
                 }
             }
 
             // Update Results Upon Successful Transaction Processing
             if (is_success) {
-                std::lock_guard<std::mutex> result_lock(mapping_mutex);
-                AllResult[thread_id].commit_cnt_++; // Increment Committed Transaction Count
+                AllResult[thread_id].commit_cnt_++; // Increment Committed Transaction Count (Own Slot)
+                AllResult[thread_id].end_to_end_.record(nowNanos() - trans.arrival_ns_);
+            } else {
+                AllResult[thread_id].abort_cnt_++;
             }
-
-            // Increase Load
-            thread_load[thread_id]++;
         }
+        cc_watermark.exit(thread_id);
         iteration_count++;
+        if (size > 0) {
+            AllResult[thread_id].cc_phase_.record(nowNanos() - batch_start);
+            __atomic_add_fetch(&tx_counter, size, __ATOMIC_RELEASE);
+        }
 
-        // Detect and Redistribute Load
+        // Detect and Redistribute Load at the Batch Boundary (the Overloaded Thread Hands Off)
         {
-            int max_load = *std::max_element(thread_load.begin(), thread_load.end());
-            int min_load = *std::min_element(thread_load.begin(), thread_load.end());
-            if (max_load - min_load > BATCH_SIZE/DEFAULT_THREAD_NUM) { // Load Difference Exceeds Threshold
-                int overloaded_thread = std::distance(thread_load.begin(),
-                                        std::max_element(thread_load.begin(), thread_load.end()));
-                int underloaded_thread = std::distance(thread_load.begin(),
-                                          std::min_element(thread_load.begin(), thread_load.end()));
-                redistributeLoad(overloaded_thread, underloaded_thread);
+            for (size_t i = 0; i < loads.size(); ++i) {
+                loads[i] = __atomic_load_n(&thread_load[i], __ATOMIC_RELAXED);
+            }
+            auto max_it = std::max_element(loads.begin(), loads.end());
+            auto min_it = std::min_element(loads.begin(), loads.end());
+            int64_t max_load = *max_it;
+            int64_t min_load = *min_it;
+            if (std::distance(loads.begin(), max_it) == thread_id &&
+                max_load - min_load > max_load / 4 &&
+                max_load - min_load > HOT_RANGE_THRESHOLD) { // Load Difference Exceeds Threshold
+                redistributeLoad(thread_id, std::distance(loads.begin(), min_it));
             }
         }
     }
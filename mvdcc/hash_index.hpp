@@ -0,0 +1,153 @@
+#ifndef HASH_INDEX_HPP
+#define HASH_INDEX_HPP
+
+#include <sys/mman.h>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+// Hash Index: Open-Addressing Table From 64-Bit Keys to Pointers
+// Buckets are one cache line of four key/value pairs, probed linearly, so a
+// lookup usually reads a single line. Any thread may insert, as long as each
+// key has one inserter (e.g. the CC thread owning it): a slot is claimed by a
+// CAS on its value, then the key is written and the value published. Lookups
+// take no locks; a slot still being filled reads as absent. Keys are never
+// removed. A full table is not rehashed in place: a table twice its size is
+// chained in front of it for further inserts, and lookups fall through to the
+// older tables, so nothing ever moves under a reader.
+template <typename Value>
+class HashIndex {
+    static_assert(std::is_pointer_v<Value>, "index values are published atomically");
+
+public:
+    static constexpr size_t SLOTS = 4;             // Pairs per bucket
+    static constexpr size_t MAX_LOAD_PERCENT = 75; // A fuller table grows
+
+    HashIndex() = default;
+    HashIndex(const HashIndex&) = delete;
+    HashIndex& operator=(const HashIndex&) = delete;
+    ~HashIndex() { clear(); }
+
+    // Drops every key; the first table is sized for capacity keys. With
+    // huge_pages the tables ask for transparent huge pages.
+    void reset(size_t capacity, bool huge_pages = false) {
+        clear();
+        size_t bucket_num = 1;
+        while (bucket_num * SLOTS * MAX_LOAD_PERCENT / 100 < capacity) bucket_num *= 2;
+        head_ = new Generation(bucket_num, huge_pages, nullptr);
+    }
+
+    // False if the key is already present. A key's inserter is the only one
+    // who can add it, so it cannot appear between the lookup and the claim.
+    bool insert(uint64_t key, Value value) {
+        if (find(key)) return false;
+        while (true) {
+            Generation* generation = __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+            if (__atomic_fetch_add(&generation->used_, 1, __ATOMIC_RELAXED) >= generation->limit_) {
+                grow(generation);
+                continue;
+            }
+            for (size_t b = hash(key) & generation->mask_; ; b = (b + 1) & generation->mask_) {
+                Bucket& bucket = generation->buckets_[b];
+                for (size_t s = 0; s < SLOTS; ++s) {
+                    Value empty = nullptr;
+                    if (__atomic_load_n(&bucket.values_[s], __ATOMIC_RELAXED) ||
+                        !__atomic_compare_exchange_n(&bucket.values_[s], &empty, claimed(), false,
+                                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                        continue;
+                    }
+                    __atomic_store_n(&bucket.keys_[s], key, __ATOMIC_RELAXED);
+                    __atomic_store_n(&bucket.values_[s], value, __ATOMIC_RELEASE);
+                    return true;
+                }
+            }
+        }
+    }
+
+    // nullptr if absent. Slots are claimed in probe order and never freed, so
+    // an empty slot ends the search of a table.
+    Value find(uint64_t key) const {
+        uint64_t home = hash(key);
+        for (const Generation* generation = __atomic_load_n(&head_, __ATOMIC_ACQUIRE); generation;
+             generation = generation->older_) {
+            for (size_t b = home & generation->mask_; ; b = (b + 1) & generation->mask_) {
+                const Bucket& bucket = generation->buckets_[b];
+                bool end = false;
+                for (size_t s = 0; s < SLOTS; ++s) {
+                    Value value = __atomic_load_n(&bucket.values_[s], __ATOMIC_ACQUIRE);
+                    if (!value) {
+                        end = true;
+                        break;
+                    }
+                    if (value != claimed() && __atomic_load_n(&bucket.keys_[s], __ATOMIC_RELAXED) == key) {
+                        return value;
+                    }
+                }
+                if (end) break;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    struct alignas(64) Bucket {
+        uint64_t keys_[SLOTS];
+        Value values_[SLOTS];
+    };
+
+    // One table; buckets are fresh zeroed pages, first touched by their inserters
+    struct Generation {
+        Generation(size_t bucket_num, bool huge_pages, Generation* older)
+            : mask_(bucket_num - 1), limit_(bucket_num * SLOTS * MAX_LOAD_PERCENT / 100),
+              huge_pages_(huge_pages), older_(older) {
+            void* data = mmap(nullptr, bucket_num * sizeof(Bucket), PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (data == MAP_FAILED) throw std::bad_alloc();
+            if (huge_pages) madvise(data, bucket_num * sizeof(Bucket), MADV_HUGEPAGE);
+            buckets_ = static_cast<Bucket*>(data);
+        }
+        ~Generation() { munmap(buckets_, (mask_ + 1) * sizeof(Bucket)); }
+
+        Bucket* buckets_;
+        size_t mask_;
+        size_t limit_;      // Claims allowed before the next table is chained
+        size_t used_ = 0;   // Claims attempted, successful or not
+        bool huge_pages_;
+        Generation* older_;
+    };
+
+    static Value claimed() { return reinterpret_cast<Value>(uintptr_t(1)); }
+
+    static uint64_t hash(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    // Chains a table twice the size of full in front of it, unless another
+    // inserter already did
+    void grow(Generation* full) {
+        Generation* bigger = new Generation((full->mask_ + 1) * 2, full->huge_pages_, full);
+        if (!__atomic_compare_exchange_n(&head_, &full, bigger, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            bigger->older_ = nullptr;
+            delete bigger;
+        }
+    }
+
+    void clear() {
+        Generation* generation = head_;
+        while (generation) {
+            Generation* older = generation->older_;
+            delete generation;
+            generation = older;
+        }
+        head_ = nullptr;
+    }
+
+    Generation* head_ = nullptr;
+};
+
+#endif // HASH_INDEX_HPP
@@ -0,0 +1,217 @@
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// NUMA Topology Read From sysfs
+// A machine without /sys/devices/system/node is treated as one node holding
+// every CPU, so NUMA mode still pins threads there.
+class NumaTopology {
+public:
+    NumaTopology() {
+        for (int node = 0; ; ++node) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file) break;
+            std::string list;
+            std::getline(file, list);
+            std::vector<int> cpus = parseCpuList(list);
+            if (!cpus.empty()) node_cpus_.push_back(cpus);
+        }
+        if (node_cpus_.empty()) {
+            std::vector<int> cpus;
+            unsigned cpu_num = std::thread::hardware_concurrency();
+            for (unsigned cpu = 0; cpu < (cpu_num ? cpu_num : 1); ++cpu) cpus.push_back(cpu);
+            node_cpus_.push_back(cpus);
+        }
+    }
+
+    size_t nodeCount() const { return node_cpus_.size(); }
+    const std::vector<int>& cpus(size_t node) const { return node_cpus_[node]; }
+
+private:
+    // "0-3,8-11" -> 0 1 2 3 8 9 10 11
+    static std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (item.empty()) continue;
+            size_t dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    std::vector<std::vector<int>> node_cpus_;
+};
+
+// Thread Placement: CPU and Node of Every Worker
+// Each group (e.g. CC threads, then execution threads) is spread over the
+// nodes in contiguous blocks, so thread i of a group of n lands on node
+// i * nodes / n. Within a node the groups take the CPUs in turn; with more
+// threads than CPUs they wrap around. Unpinned placements report node -1.
+class ThreadPlacement {
+public:
+    ThreadPlacement() = default;
+
+    ThreadPlacement(const NumaTopology& topology, const std::vector<size_t>& group_sizes) {
+        std::vector<size_t> next_cpu(topology.nodeCount(), 0);
+        for (size_t group_size : group_sizes) {
+            for (size_t i = 0; i < group_size; ++i) {
+                size_t node = i * topology.nodeCount() / group_size;
+                const std::vector<int>& cpus = topology.cpus(node);
+                cpus_.push_back(cpus[next_cpu[node]++ % cpus.size()]);
+                nodes_.push_back(static_cast<int>(node));
+            }
+        }
+    }
+
+    bool pinned() const { return !cpus_.empty(); }
+    int cpu(size_t thread_id) const { return pinned() ? cpus_[thread_id] : -1; }
+    int node(size_t thread_id) const { return pinned() ? nodes_[thread_id] : -1; }
+
+    // Binds the calling thread to the CPU of thread_id; a no-op when unpinned
+    bool pin(size_t thread_id) const {
+        if (!pinned()) return true;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus_[thread_id], &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+private:
+    std::vector<int> cpus_;
+    std::vector<int> nodes_;
+};
+
+// Node Currently Backing Each Address (move_pages Without Target Nodes Only
+// Queries); -1 Where Unknown, e.g. Without NUMA Support in the Kernel
+inline std::vector<int> pageNodes(const std::vector<const void*>& addresses) {
+    std::vector<int> status(addresses.size(), -1);
+    std::vector<void*> pages;
+    pages.reserve(addresses.size());
+    for (const void* address : addresses) {
+        uintptr_t page = reinterpret_cast<uintptr_t>(address) & ~(uintptr_t(sysconf(_SC_PAGESIZE)) - 1);
+        pages.push_back(reinterpret_cast<void*>(page));
+    }
+#ifdef SYS_move_pages
+    if (!pages.empty() &&
+        syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) {
+        status.assign(addresses.size(), -1);
+    }
+#endif
+    for (int& node : status) {
+        if (node < 0) node = -1;
+    }
+    return status;
+}
+
+// Memory Placement of Per-Record Data Relative to the Owning Thread's Node
+struct PlacementReport {
+    uint64_t local_ = 0;
+    uint64_t remote_ = 0;
+    uint64_t unknown_ = 0;
+
+    double localShare() const {
+        uint64_t known = local_ + remote_;
+        return known ? static_cast<double>(local_) / known : 0.0;
+    }
+};
+
+inline void printPlacement(std::ostream& out, const char* what, const PlacementReport& report) {
+    out << "[NUMA] " << what << ": " << report.local_ << " local, " << report.remote_ << " remote";
+    if (report.unknown_) out << ", " << report.unknown_ << " unknown";
+    out << " (" << 100.0 * report.localShare() << "% local)" << std::endl;
+}
+
+// Samples up to sample_num records: owner(key) is the owning thread id,
+// address(key) the memory checked against that thread's node
+template <typename Owner, typename Address>
+PlacementReport samplePlacement(size_t record_num, const ThreadPlacement& placement,
+                                size_t sample_num, Owner owner, Address address) {
+    PlacementReport report;
+    if (record_num == 0 || !placement.pinned()) return report;
+    size_t stride = record_num > sample_num ? record_num / sample_num : 1;
+    std::vector<uint64_t> keys;
+    std::vector<const void*> addresses;
+    for (uint64_t key = 0; key < record_num; key += stride) {
+        keys.push_back(key);
+        addresses.push_back(address(key));
+    }
+    std::vector<int> nodes = pageNodes(addresses);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (nodes[i] < 0) report.unknown_++;
+        else if (nodes[i] == placement.node(owner(keys[i]))) report.local_++;
+        else report.remote_++;
+    }
+    return report;
+}
+
+// Page-Aligned Array in Its Own Anonymous Mapping
+// Unlike heap memory, every allocation starts out as fresh pages, so the
+// thread that first writes a page decides its node. Elements are not constructed.
+// With huge_pages the mapping is backed by transparent huge pages where the
+// kernel allows it, cutting TLB misses over large tables; otherwise it keeps
+// base pages.
+template <typename T>
+class PageArray {
+public:
+    PageArray() = default;
+    PageArray(const PageArray&) = delete;
+    PageArray& operator=(const PageArray&) = delete;
+    ~PageArray() { release(); }
+
+    T* allocate(size_t size, bool huge_pages = false) {
+        release();
+        if (size == 0) return nullptr;
+        void* data = mmap(nullptr, size * sizeof(T), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) throw std::bad_alloc();
+        if (huge_pages) madvise(data, size * sizeof(T), MADV_HUGEPAGE);
+        data_ = static_cast<T*>(data);
+        size_ = size;
+        return data_;
+    }
+
+    void release() {
+        if (data_) munmap(data_, size_ * sizeof(T));
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    T* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Runs body(thread_id) on thread_num threads pinned like the workers, and waits for them
+template <typename Body>
+void runPinned(const ThreadPlacement& placement, size_t thread_num, Body body) {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_num; ++i) {
+        threads.emplace_back([&placement, &body, i] {
+            placement.pin(i);
+            body(i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+}
+
+#endif // NUMA_HPP
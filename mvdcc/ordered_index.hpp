@@ -0,0 +1,295 @@
+#ifndef ORDERED_INDEX_HPP
+#define ORDERED_INDEX_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <type_traits>
+
+#ifndef INDEX_NODE_SLOTS
+#define INDEX_NODE_SLOTS 16        // Keys per ordered index node
+#endif
+
+// Ordered Index: B+-Tree From 64-Bit Keys to Pointers, One Writer, Lock-Free Readers
+// Every node keeps its keys packed together, so a search touches a couple of
+// cache lines per level, and scans walk the leaves through their sibling
+// links. Only one thread inserts (e.g. the CC thread owning a partition);
+// readers never block it. Each node has a version that is odd while the
+// writer changes it: readers note it before reading the node, check it again
+// afterwards and restart on a change. A split keeps the split node changing
+// until its parent links the new sibling. Keys are never removed.
+template <typename Value>
+class OrderedIndex {
+    static_assert(std::is_pointer_v<Value>, "index values are published atomically");
+
+public:
+    static constexpr size_t SLOTS = INDEX_NODE_SLOTS;
+
+    OrderedIndex() { root_ = newLeaf(); }
+    OrderedIndex(const OrderedIndex&) = delete;
+    OrderedIndex& operator=(const OrderedIndex&) = delete;
+
+    // Writer only: false if the key is already present
+    bool insert(uint64_t key, Value value) {
+        Inner* path[MAX_DEPTH];
+        size_t depth = 0;
+        Node* node = root_;
+        while (!node->leaf_) {
+            Inner* inner = static_cast<Inner*>(node);
+            path[depth++] = inner;
+            node = inner->children_[childIndex(inner->keys_, inner->count_, key)];
+        }
+        Leaf* leaf = static_cast<Leaf*>(node);
+        size_t pos = std::lower_bound(leaf->keys_, leaf->keys_ + leaf->count_, key) - leaf->keys_;
+        if (pos < leaf->count_ && leaf->keys_[pos] == key) return false;
+        size_ += 1;
+
+        if (leaf->count_ < SLOTS) {
+            lock(leaf);
+            insertAt(leaf->keys_, leaf->values_, leaf->count_, pos, key, value);
+            __atomic_store_n(&leaf->count_, leaf->count_ + 1, __ATOMIC_RELAXED);
+            unlock(leaf);
+            return true;
+        }
+
+        // Split, keeping the left leaf full when appending at the right edge
+        // (e.g. a load in key order), otherwise halving it
+        uint64_t keys[SLOTS + 1];
+        Value values[SLOTS + 1];
+        std::copy(leaf->keys_, leaf->keys_ + SLOTS, keys);
+        std::copy(leaf->values_, leaf->values_ + SLOTS, values);
+        insertAt(keys, values, SLOTS, pos, key, value);
+        size_t left_num = pos == SLOTS && !leaf->next_ ? SLOTS : (SLOTS + 1) / 2;
+        Leaf* right = newLeaf();
+        right->count_ = SLOTS + 1 - left_num;
+        std::copy(keys + left_num, keys + SLOTS + 1, right->keys_);
+        std::copy(values + left_num, values + SLOTS + 1, right->values_);
+        right->next_ = leaf->next_;
+
+        Node* locked[MAX_DEPTH + 1];
+        size_t locked_num = 0;
+        lock(leaf);
+        locked[locked_num++] = leaf;
+        for (size_t i = 0; i < left_num; ++i) {
+            __atomic_store_n(&leaf->keys_[i], keys[i], __ATOMIC_RELAXED);
+            __atomic_store_n(&leaf->values_[i], values[i], __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&leaf->count_, left_num, __ATOMIC_RELAXED);
+        __atomic_store_n(&leaf->next_, right, __ATOMIC_RELEASE);
+        insertSeparator(path, depth, leaf, right->keys_[0], right, locked, locked_num);
+        for (size_t i = 0; i < locked_num; ++i) unlock(locked[i]);
+        return true;
+    }
+
+    // Value stored under key, if any
+    std::optional<Value> find(uint64_t key) const {
+        while (true) {
+            uint64_t version;
+            const Leaf* leaf = findLeaf(key, version);
+            size_t count = std::min<size_t>(__atomic_load_n(&leaf->count_, __ATOMIC_RELAXED), SLOTS);
+            std::optional<Value> value;
+            for (size_t i = 0; i < count; ++i) {
+                if (__atomic_load_n(&leaf->keys_[i], __ATOMIC_RELAXED) == key) {
+                    value = __atomic_load_n(&leaf->values_[i], __ATOMIC_RELAXED);
+                    break;
+                }
+            }
+            if (validate(leaf, version)) return value;
+        }
+    }
+
+    // Visits every (key, value) with first <= key <= last in key order. Each
+    // leaf is copied out and validated before any of it is visited, so visit
+    // only sees consistent entries; after a conflict the scan continues after
+    // the last key it visited.
+    template <typename Visit>
+    void scan(uint64_t first, uint64_t last, Visit visit) const {
+        uint64_t keys[SLOTS];
+        Value values[SLOTS];
+        while (first <= last) {
+            uint64_t version;
+            const Leaf* leaf = findLeaf(first, version);
+            while (true) {
+                size_t count = std::min<size_t>(__atomic_load_n(&leaf->count_, __ATOMIC_RELAXED), SLOTS);
+                size_t found = 0;
+                bool past_end = false;
+                for (size_t i = 0; i < count; ++i) {
+                    uint64_t key = __atomic_load_n(&leaf->keys_[i], __ATOMIC_RELAXED);
+                    if (key < first) continue;
+                    if (key > last) {
+                        past_end = true;
+                        break;
+                    }
+                    keys[found] = key;
+                    values[found++] = __atomic_load_n(&leaf->values_[i], __ATOMIC_RELAXED);
+                }
+                const Leaf* next = __atomic_load_n(&leaf->next_, __ATOMIC_ACQUIRE);
+                if (!validate(leaf, version)) break;
+                for (size_t i = 0; i < found; ++i) visit(keys[i], values[i]);
+                if (found) {
+                    if (keys[found - 1] == last) return;
+                    first = keys[found - 1] + 1;
+                }
+                if (past_end || !next) return;
+                leaf = next;
+                version = stableVersion(leaf);
+            }
+        }
+    }
+
+    // Keys inserted so far; writer only
+    size_t size() const { return size_; }
+
+private:
+    static constexpr size_t MAX_DEPTH = 16;
+
+    struct alignas(64) Node {
+        uint64_t version_ = 0;
+        uint32_t count_ = 0;
+        bool leaf_;
+
+        explicit Node(bool leaf) : leaf_(leaf) {}
+    };
+
+    // Keys ascending; count_ entries
+    struct Leaf : Node {
+        Leaf* next_ = nullptr;
+        uint64_t keys_[SLOTS];
+        Value values_[SLOTS];
+
+        Leaf() : Node(true) {}
+    };
+
+    // count_ separators, count_ + 1 children: children_[i] holds the keys
+    // below keys_[i] and at or above keys_[i - 1]
+    struct Inner : Node {
+        uint64_t keys_[SLOTS];
+        Node* children_[SLOTS + 1];
+
+        Inner() : Node(false) {}
+    };
+
+    static size_t childIndex(const uint64_t* keys, size_t count, uint64_t key) {
+        return std::upper_bound(keys, keys + count, key) - keys;
+    }
+
+    template <typename Slot>
+    static void insertAt(uint64_t* keys, Slot* slots, size_t count, size_t pos, uint64_t key, Slot slot) {
+        for (size_t i = count; i > pos; --i) {
+            __atomic_store_n(&keys[i], keys[i - 1], __ATOMIC_RELAXED);
+            __atomic_store_n(&slots[i], slots[i - 1], __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&keys[pos], key, __ATOMIC_RELAXED);
+        __atomic_store_n(&slots[pos], slot, __ATOMIC_RELAXED);
+    }
+
+    // Links right, split off left, into the parent at path[depth - 1]; splits
+    // full parents upwards and grows a new root above the old one if needed.
+    // Every node changed is locked and added to locked.
+    void insertSeparator(Inner** path, size_t depth, Node* left, uint64_t separator, Node* right,
+                         Node** locked, size_t& locked_num) {
+        while (depth > 0) {
+            Inner* parent = path[--depth];
+            size_t pos = childIndex(parent->keys_, parent->count_, separator);
+            lock(parent);
+            locked[locked_num++] = parent;
+            if (parent->count_ < SLOTS) {
+                insertAt(parent->keys_, parent->children_ + 1, parent->count_, pos, separator, right);
+                __atomic_store_n(&parent->count_, parent->count_ + 1, __ATOMIC_RELEASE);
+                return;
+            }
+
+            uint64_t keys[SLOTS + 1];
+            Node* children[SLOTS + 2];
+            std::copy(parent->keys_, parent->keys_ + SLOTS, keys);
+            std::copy(parent->children_, parent->children_ + SLOTS + 1, children);
+            insertAt(keys, children + 1, SLOTS, pos, separator, right);
+            // the middle separator moves up; at the right edge the left node stays full
+            bool edge = pos == SLOTS && depth == rightEdgeDepth(path, depth);
+            size_t left_num = edge ? SLOTS : SLOTS / 2;
+            Inner* sibling = newInner();
+            sibling->count_ = SLOTS - left_num;
+            std::copy(keys + left_num + 1, keys + SLOTS + 1, sibling->keys_);
+            std::copy(children + left_num + 1, children + SLOTS + 2, sibling->children_);
+            for (size_t i = 0; i < left_num; ++i) {
+                __atomic_store_n(&parent->keys_[i], keys[i], __ATOMIC_RELAXED);
+                __atomic_store_n(&parent->children_[i + 1], children[i + 1], __ATOMIC_RELEASE);
+            }
+            __atomic_store_n(&parent->count_, left_num, __ATOMIC_RELAXED);
+            left = parent;
+            separator = keys[left_num];
+            right = sibling;
+        }
+        Inner* root = newInner();
+        root->count_ = 1;
+        root->keys_[0] = separator;
+        root->children_[0] = left;
+        root->children_[1] = right;
+        __atomic_store_n(&root_, static_cast<Node*>(root), __ATOMIC_RELEASE);
+    }
+
+    // Depth down to which path follows the rightmost child of every node
+    static size_t rightEdgeDepth(Inner** path, size_t depth) {
+        size_t edge = 0;
+        while (edge < depth && path[edge]->children_[path[edge]->count_] == path[edge + 1]) ++edge;
+        return edge;
+    }
+
+    // Leaf that holds key, with the version it was found at
+    const Leaf* findLeaf(uint64_t key, uint64_t& version) const {
+        while (true) {
+            const Node* node = __atomic_load_n(&root_, __ATOMIC_ACQUIRE);
+            version = stableVersion(node);
+            // a root that split after it was loaded is no longer the root
+            if (__atomic_load_n(&root_, __ATOMIC_ACQUIRE) != node) continue;
+            bool conflict = false;
+            while (!node->leaf_) {
+                const Inner* inner = static_cast<const Inner*>(node);
+                size_t count = std::min<size_t>(__atomic_load_n(&inner->count_, __ATOMIC_ACQUIRE), SLOTS);
+                size_t low = 0;
+                while (low < count && __atomic_load_n(&inner->keys_[low], __ATOMIC_RELAXED) <= key) ++low;
+                const Node* child = __atomic_load_n(&inner->children_[low], __ATOMIC_ACQUIRE);
+                uint64_t child_version = stableVersion(child);
+                if (!validate(node, version)) {
+                    conflict = true;
+                    break;
+                }
+                node = child;
+                version = child_version;
+            }
+            if (!conflict) return static_cast<const Leaf*>(node);
+        }
+    }
+
+    static uint64_t stableVersion(const Node* node) {
+        while (true) {
+            uint64_t version = __atomic_load_n(&node->version_, __ATOMIC_ACQUIRE);
+            if (!(version & 1)) return version;
+        }
+    }
+
+    static bool validate(const Node* node, uint64_t version) {
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        return __atomic_load_n(&node->version_, __ATOMIC_RELAXED) == version;
+    }
+
+    static void lock(Node* node) {
+        __atomic_store_n(&node->version_, node->version_ + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+
+    static void unlock(Node* node) {
+        __atomic_store_n(&node->version_, node->version_ + 1, __ATOMIC_RELEASE);
+    }
+
+    Leaf* newLeaf() { return &leaves_.emplace_back(); }
+    Inner* newInner() { return &inners_.emplace_back(); }
+
+    Node* root_;
+    size_t size_ = 0;
+    std::deque<Leaf> leaves_;   // Nodes live as long as the index
+    std::deque<Inner> inners_;
+};
+
+#endif // ORDERED_INDEX_HPP
@@ -0,0 +1,114 @@
+#ifndef PARTITIONER_HPP
+#define PARTITIONER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Record Ownership Strategies for the CC Phase
+enum class PartitionStrategy { MODULO, RANGE, HASH, TABLE };
+
+inline PartitionStrategy parsePartitionStrategy(const std::string& name) {
+    if (name == "modulo") return PartitionStrategy::MODULO;
+    if (name == "range") return PartitionStrategy::RANGE;
+    if (name == "hash") return PartitionStrategy::HASH;
+    if (name == "table") return PartitionStrategy::TABLE;
+    throw std::invalid_argument("unknown partition strategy: " + name);
+}
+
+inline const char* partitionStrategyName(PartitionStrategy strategy) {
+    switch (strategy) {
+    case PartitionStrategy::MODULO: return "modulo";
+    case PartitionStrategy::RANGE: return "range";
+    case PartitionStrategy::HASH: return "hash";
+    case PartitionStrategy::TABLE: return "table";
+    }
+    return "unknown";
+}
+
+// Partitioner: Constant-Time Record-to-CC-Thread Ownership
+class Partitioner {
+public:
+    void build(PartitionStrategy strategy, size_t thread_num, size_t tuple_num) {
+        strategy_ = strategy;
+        thread_num_ = thread_num;
+        tuple_num_ = tuple_num;
+        range_size_ = (tuple_num + thread_num - 1) / thread_num;
+        if (range_size_ == 0) range_size_ = 1;
+        table_.clear();
+        if (strategy == PartitionStrategy::TABLE) {
+            // Explicit Table Starts Out Round-Robin; Use assign() to Override
+            table_.resize(tuple_num);
+            for (uint64_t key = 0; key < tuple_num; ++key) {
+                table_[key] = static_cast<uint16_t>(key % thread_num);
+            }
+        }
+    }
+
+    // Override a Single Record (TABLE Strategy Only)
+    void assign(uint64_t key, int thread_id) {
+        table_[key] = static_cast<uint16_t>(thread_id);
+    }
+
+    int owner(uint64_t key) const {
+        switch (strategy_) {
+        case PartitionStrategy::MODULO:
+            return static_cast<int>(key % thread_num_);
+        case PartitionStrategy::RANGE: {
+            uint64_t thread_id = key / range_size_;
+            return static_cast<int>(thread_id < thread_num_ ? thread_id : thread_num_ - 1);
+        }
+        case PartitionStrategy::HASH:
+            // Multiply-Shift Range Reduction Avoids a Division
+            return static_cast<int>((static_cast<unsigned __int128>(mix(key)) * thread_num_) >> 64);
+        case PartitionStrategy::TABLE:
+            // Records Added Beyond the Table Are Dealt Out Round-Robin
+            return key < table_.size() ? table_[key] : static_cast<int>(key % thread_num_);
+        }
+        return 0;
+    }
+
+    bool owns(int thread_id, uint64_t key) const { return owner(key) == thread_id; }
+
+    // Whether forEachOwned() Can Enumerate a Thread's Keys Without Testing Every Key
+    bool enumerable() const {
+        return strategy_ == PartitionStrategy::MODULO || strategy_ == PartitionStrategy::RANGE;
+    }
+
+    // Visits the Keys Below key_num Owned by thread_id, in Key Order; enumerable() Only
+    template <typename Visit>
+    void forEachOwned(int thread_id, uint64_t key_num, Visit visit) const {
+        if (strategy_ == PartitionStrategy::MODULO) {
+            for (uint64_t key = thread_id; key < key_num; key += thread_num_) visit(key);
+            return;
+        }
+        uint64_t first = thread_id * range_size_;
+        uint64_t last = static_cast<size_t>(thread_id) + 1 == thread_num_
+            ? key_num : std::min<uint64_t>(key_num, first + range_size_);
+        for (uint64_t key = first; key < last; ++key) visit(key);
+    }
+
+    PartitionStrategy strategy() const { return strategy_; }
+    size_t threadNum() const { return thread_num_; }
+    size_t tupleNum() const { return tuple_num_; }
+
+private:
+    static uint64_t mix(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    PartitionStrategy strategy_ = PartitionStrategy::MODULO;
+    size_t thread_num_ = 1;
+    size_t tuple_num_ = 0;
+    uint64_t range_size_ = 1;
+    std::vector<uint16_t> table_;
+};
+
+#endif // PARTITIONER_HPP
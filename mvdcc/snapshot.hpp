@@ -0,0 +1,172 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Snapshot File: One Page of Header, the Key of Every Record, Then Their
+// Images in the Same Order, payload_size_ Bytes Each. Keys and Images Start
+// Page-Aligned, So the File Is Mapped and Used as the Table's Initial Records
+// Without Being Read or Copied.
+struct SnapshotHeader {
+    static constexpr uint64_t MAGIC = 0x32504e534d484f42ULL; // "BOHMSNP2"
+    static constexpr size_t SIZE = 4096;
+
+    uint64_t magic_;
+    uint64_t timestamp_;       // First Timestamp Not Included: the State Before It
+    uint64_t record_num_;      // Records That Existed Before timestamp_
+    uint64_t payload_size_;
+    uint64_t tuple_num_;       // Key Space of the Workload: Records Loaded Initially
+    uint64_t sparse_;          // Whether Their Keys Are Sparse
+
+    // Bytes of the Keys, Padded to a Page
+    static size_t keyBytes(uint64_t record_num) {
+        return (record_num * sizeof(uint64_t) + SIZE - 1) / SIZE * SIZE;
+    }
+};
+
+// Writes a Snapshot of header.record_num_ Records Next to path and Renames It
+// Into Place Once Synced, So a Crash Never Leaves a Partial File Behind.
+// records(emit) Calls emit(key, image) for Every Record, Its Image as of the
+// Timestamp, in the Same Order Each Time: It Runs Once for the Keys and Once
+// for the Images, Which Are Streamed to the File as They Come, So Nothing Is
+// Held per Record. cancelled() Is Polled Between Writes and Abandons the
+// Snapshot (e.g. on Shutdown) When True.
+template <typename Records, typename Cancelled>
+bool writeSnapshot(const std::string& path, const SnapshotHeader& header, Records records,
+                   Cancelled cancelled) {
+    std::string temp_path = path + ".tmp";
+    int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), "cannot open " + temp_path);
+
+    auto flush = [fd, &temp_path](std::vector<char>& buffer) {
+        size_t done = 0;
+        while (done < buffer.size()) {
+            ssize_t n = ::write(fd, buffer.data() + done, buffer.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) throw std::system_error(errno, std::generic_category(), "write " + temp_path);
+            done += n;
+        }
+        buffer.clear();
+    };
+    auto abandon = [fd, &temp_path] {
+        ::close(fd);
+        ::unlink(temp_path.c_str());
+    };
+
+    try {
+        std::vector<char> buffer(SnapshotHeader::SIZE, 0);
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        const size_t flush_size = 1 << 20;
+        bool abandoned = false;
+        // One pass over the records, writing their keys or their images
+        auto pass = [&](bool keys) {
+            uint64_t count = 0;
+            records([&](uint64_t key, std::span<const char> image) {
+                if (abandoned || ++count > header.record_num_) return;
+                if (keys) {
+                    const char* bytes = reinterpret_cast<const char*>(&key);
+                    buffer.insert(buffer.end(), bytes, bytes + sizeof(key));
+                } else {
+                    buffer.insert(buffer.end(), image.begin(), image.end());
+                }
+                if (buffer.size() >= flush_size) {
+                    flush(buffer);
+                    abandoned = cancelled();
+                }
+            });
+            if (!abandoned && count != header.record_num_) {
+                throw std::runtime_error("snapshot records changed while being written to " + temp_path);
+            }
+        };
+        pass(true);
+        buffer.resize(buffer.size() + SnapshotHeader::keyBytes(header.record_num_) -
+                      header.record_num_ * sizeof(uint64_t), 0);
+        if (!abandoned) pass(false);
+        if (abandoned) {
+            abandon();
+            return false;
+        }
+        flush(buffer);
+        if (fdatasync(fd) != 0) throw std::system_error(errno, std::generic_category(), "fdatasync " + temp_path);
+    } catch (...) {
+        abandon();
+        throw;
+    }
+    ::close(fd);
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        throw std::system_error(errno, std::generic_category(), "rename " + temp_path);
+    }
+    return true;
+}
+
+// Read-Only Mapping of a Snapshot File
+// Pages Are Faulted in on First Access, So Opening Costs the Same for Any Size.
+class MappedSnapshot {
+public:
+    MappedSnapshot() = default;
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+    ~MappedSnapshot() { release(); }
+
+    void open(const std::string& path) {
+        release();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "cannot open snapshot " + path);
+        struct stat status;
+        if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < SnapshotHeader::SIZE) {
+            ::close(fd);
+            throw std::runtime_error("not a snapshot: " + path);
+        }
+        size_t size = status.st_size;
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap " + path);
+        data_ = static_cast<char*>(data);
+        size_ = size;
+
+        const SnapshotHeader& head = header();
+        if (head.magic_ != SnapshotHeader::MAGIC ||
+            size_ != SnapshotHeader::SIZE + SnapshotHeader::keyBytes(head.record_num_) +
+                     head.record_num_ * head.payload_size_) {
+            release();
+            throw std::runtime_error("corrupt snapshot: " + path);
+        }
+    }
+
+    void release() {
+        if (data_) munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    bool isOpen() const { return data_ != nullptr; }
+    const SnapshotHeader& header() const { return *reinterpret_cast<const SnapshotHeader*>(data_); }
+
+    uint64_t key(uint64_t record) const {
+        return reinterpret_cast<const uint64_t*>(data_ + SnapshotHeader::SIZE)[record];
+    }
+
+    // The Mapping Is Read-Only: Tuples Only Read Their Initial Image, Updates Go to New Versions
+    char* image(uint64_t record) const {
+        return data_ + SnapshotHeader::SIZE + SnapshotHeader::keyBytes(header().record_num_) +
+               record * header().payload_size_;
+    }
+
+private:
+    char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,105 @@
+#ifndef SPLIT_CONTROLLER_HPP
+#define SPLIT_CONTROLLER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef SPLIT_INTERVAL
+#define SPLIT_INTERVAL 8           // Batches between decisions of the adaptive CC/execution split
+#endif
+
+// Split Controller: Workers Between the CC and the Execution Phase
+// The first ccThreads() workers run the CC phase of a batch, the others
+// execute; the sequencer decides the split of every batch as it publishes
+// it, so a worker changes its role only at a batch boundary. An adaptive
+// split is revisited every SPLIT_INTERVAL batches: a worker moves to the side
+// the ring shows lagging behind, sequenced batches waiting for the CC phase
+// or released ones waiting for execution, as long as the busy time of the two
+// phases since the last decision agrees. The phases are balanced when each
+// one's busy time divided by its threads is the same. The ring is anything
+// that reports its releasedBatches() and retiredBatches().
+class SplitController {
+public:
+    void init(size_t worker_num, size_t cc_threads, bool adaptive) {
+        worker_num_ = worker_num;
+        cc_threads_ = cc_threads;
+        adaptive_ = adaptive;
+        next_decision_ = SPLIT_INTERVAL;
+        last_cc_ns_ = last_exec_ns_ = 0;
+        batch_num_ = thread_batches_ = changes_ = 0;
+        clocks_ = std::vector<PhaseClock>(worker_num);
+    }
+
+    // Workers: busy time in each phase, kept by every worker for itself
+    void addCC(size_t thread_id, uint64_t ns) { add(clocks_[thread_id].cc_ns_, ns); }
+    void addExecution(size_t thread_id, uint64_t ns) { add(clocks_[thread_id].exec_ns_, ns); }
+
+    // Sequencer: the number of CC threads of batch_id
+    template <typename Ring>
+    size_t ccThreads(uint64_t batch_id, const Ring& ring) {
+        if (adaptive_ && batch_id >= next_decision_) {
+            next_decision_ = batch_id + SPLIT_INTERVAL;
+            decide(batch_id, ring.releasedBatches(), ring.retiredBatches());
+        }
+        batch_num_++;
+        thread_batches_ += cc_threads_;
+        return cc_threads_;
+    }
+
+    double averageCCThreads() const {
+        return batch_num_ ? static_cast<double>(thread_batches_) / batch_num_ : cc_threads_;
+    }
+    uint64_t changes() const { return changes_; }
+
+private:
+    struct alignas(64) PhaseClock {
+        uint64_t cc_ns_ = 0;
+        uint64_t exec_ns_ = 0;
+    };
+
+    static void add(uint64_t& clock, uint64_t ns) {
+        __atomic_store_n(&clock, __atomic_load_n(&clock, __ATOMIC_RELAXED) + ns, __ATOMIC_RELAXED);
+    }
+
+    void decide(uint64_t batch_id, uint64_t released, uint64_t retired) {
+        uint64_t cc_ns = 0;
+        uint64_t exec_ns = 0;
+        for (const PhaseClock& clock : clocks_) {
+            cc_ns += __atomic_load_n(&clock.cc_ns_, __ATOMIC_RELAXED);
+            exec_ns += __atomic_load_n(&clock.exec_ns_, __ATOMIC_RELAXED);
+        }
+        uint64_t cc_busy = cc_ns - last_cc_ns_;
+        uint64_t exec_busy = exec_ns - last_exec_ns_;
+        last_cc_ns_ = cc_ns;
+        last_exec_ns_ = exec_ns;
+        if (cc_busy + exec_busy == 0) return;
+
+        uint64_t cc_backlog = batch_id - std::min(batch_id, released);
+        uint64_t exec_backlog = released - std::min(released, retired);
+        size_t balanced = static_cast<size_t>(
+            std::lround(static_cast<double>(worker_num_) * cc_busy / (cc_busy + exec_busy)));
+        if (cc_backlog > exec_backlog && balanced > cc_threads_ && cc_threads_ + 1 < worker_num_) {
+            cc_threads_++;
+            changes_++;
+        } else if (exec_backlog > cc_backlog && balanced < cc_threads_ && cc_threads_ > 1) {
+            cc_threads_--;
+            changes_++;
+        }
+    }
+
+    size_t worker_num_ = 2;
+    size_t cc_threads_ = 1;
+    bool adaptive_ = false;
+    uint64_t next_decision_ = 0;
+    uint64_t last_cc_ns_ = 0;
+    uint64_t last_exec_ns_ = 0;
+    uint64_t batch_num_ = 0;      // Batches split so far
+    uint64_t thread_batches_ = 0; // Their CC threads, summed
+    uint64_t changes_ = 0;
+    std::vector<PhaseClock> clocks_;
+};
+
+#endif // SPLIT_CONTROLLER_HPP
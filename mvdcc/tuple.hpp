@@ -0,0 +1,245 @@
+#ifndef TUPLE_HPP
+#define TUPLE_HPP
+
+#include "version_arena.hpp"
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#ifndef READY_SPIN_LIMIT
+#define READY_SPIN_LIMIT 1024      // Polls of a placeholder before deferring the reader
+#endif
+
+// Intrusive Link for Work Waiting on a Placeholder (e.g. a Deferred Transaction)
+struct VersionWaiter {
+    VersionWaiter* next_waiter_ = nullptr;
+};
+
+// Read-Only View of a Record Image; Valid While the Reading Transaction Runs
+using Payload = std::span<const char>;
+
+// Tuple Class: Records in the Database
+// One cache line: the newest committed version (timestamp and image) is
+// referenced inline, next to the head of the version chain. The chain holds
+// placeholders and any older version a running reader may still need, so a
+// record whose writes have all executed is read without walking the chain.
+// Images are payload_size_ bytes; reads return views, never copies.
+class alignas(64) Tuple {
+public:
+    // A placeholder's waiters_ lists the readers deferred on it; once the
+    // image is written the list is closed by storing the filled() marker.
+    struct Version {
+        uint64_t begin_timestamp_;
+        uint64_t end_timestamp_;
+        char* data_;             // The version's own trailing bytes, or a record's initial image
+        VersionWaiter* waiters_;
+        Version* prev_pointer_;
+
+        Version(uint64_t begin, uint64_t end, char* data, bool placeholder, Version* prev)
+            : begin_timestamp_(begin), end_timestamp_(end), data_(data),
+              waiters_(placeholder ? nullptr : filled()), prev_pointer_(prev) {}
+
+        bool isPlaceholder() const {
+            return __atomic_load_n(&waiters_, __ATOMIC_ACQUIRE) != filled();
+        }
+
+        // Payload bytes the arena allocates right behind the version
+        char* trailing() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    // Arena object size for versions carrying payload_size bytes
+    static size_t versionSize(size_t payload_size) { return sizeof(Version) + payload_size; }
+
+    static VersionWaiter* filled() {
+        return reinterpret_cast<VersionWaiter*>(uintptr_t(1));
+    }
+
+    // Newest placeholder or spilled version; nullptr while the inline version is the only one
+    Version* latest_version_;
+
+    Tuple() : Tuple(nullptr, 0) {}
+
+    // initial is the record's image at timestamp 0, owned by the table
+    Tuple(char* initial, uint32_t payload_size)
+        : latest_version_(nullptr), head_begin_(0), seq_(0), committed_timestamp_(0),
+          committed_data_(initial), payload_size_(payload_size) {}
+
+    // The arena belongs to the CC thread that owns this record's partition and
+    // must hold versionSize(payload) bytes per version. Returns the placeholder
+    // so the writer can fill it without a chain walk. The first placeholder
+    // spills the inline version into the chain, since earlier readers may
+    // still need it once the placeholder commits; its image is not copied.
+    Version* addPlaceholder(uint64_t timestamp, SlabArena<Version>& arena) {
+        Version* head = latest_version_;
+        if (!head) {
+            // No placeholder is pending, so nobody updates the inline version now
+            head = arena.allocate(committed_timestamp_, timestamp, committed_data_, false, nullptr);
+        } else {
+            // Readers of earlier batches may walk the chain concurrently
+            __atomic_store_n(&head->end_timestamp_, timestamp, __ATOMIC_RELAXED);
+        }
+        auto new_version = arena.allocate(timestamp, UINT64_MAX, nullptr, true, head);
+        new_version->data_ = new_version->trailing();
+        __atomic_store_n(&latest_version_, new_version, __ATOMIC_RELEASE);
+        __atomic_store_n(&head_begin_, timestamp, __ATOMIC_RELEASE);
+        return new_version;
+    }
+
+    // Where the writer of a placeholder builds its new image in place
+    std::span<char> image(Version* placeholder) const { return {placeholder->data_, payload_size_}; }
+
+    // Publishes the image and returns the waiters deferred on it, to be requeued.
+    // A version newer than the inline one replaces it.
+    VersionWaiter* fillPlaceholder(Version* version) {
+        VersionWaiter* waiters = __atomic_exchange_n(&version->waiters_, filled(), __ATOMIC_ACQ_REL);
+        commitInline(version->begin_timestamp_, version->data_);
+        return waiters;
+    }
+
+    uint32_t payloadSize() const { return payload_size_; }
+
+    // Placeholder a CC-phase read at the current end of the chain must wait
+    // for; nullptr when the newest version is committed inline
+    Version* pendingVersion() const {
+        if (__atomic_load_n(&head_begin_, __ATOMIC_ACQUIRE) <=
+            __atomic_load_n(&committed_timestamp_, __ATOMIC_RELAXED)) {
+            return nullptr;
+        }
+        return __atomic_load_n(&latest_version_, __ATOMIC_ACQUIRE);
+    }
+
+    // Version a CC-phase read at the current end of the chain sees, pending
+    // or committed, so the reader never walks past versions added after it;
+    // nullptr while the record has never been written
+    Version* newestVersion() const { return __atomic_load_n(&latest_version_, __ATOMIC_ACQUIRE); }
+
+    // Image of a version resolved by the CC phase; nullopt while still a placeholder
+    std::optional<Payload> readResolved(Version* version) const {
+        if (version->isPlaceholder()) return std::nullopt;
+        return Payload(version->data_, payload_size_);
+    }
+
+    // Polls a placeholder briefly before the caller gives up its thread
+    std::optional<Payload> spinResolved(Version* version) const {
+        for (int spin = 0; spin < READY_SPIN_LIMIT; ++spin) {
+            if (!version->isPlaceholder()) return Payload(version->data_, payload_size_);
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+        return readResolved(version);
+    }
+
+    // Parks a waiter on a placeholder; false if it was filled in the meantime
+    static bool addWaiter(Version* version, VersionWaiter* waiter) {
+        VersionWaiter* head = __atomic_load_n(&version->waiters_, __ATOMIC_ACQUIRE);
+        do {
+            if (head == filled()) return false;
+            waiter->next_waiter_ = head;
+        } while (!__atomic_compare_exchange_n(&version->waiters_, &head, waiter, false,
+                                              __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+        return true;
+    }
+
+    // Detach versions no reader at or after low_watermark can see; a version
+    // ending at low_watermark is kept for a read that precedes its own write.
+    // Only the partition owner may call this; returns the detached tail.
+    Version* pruneVersions(uint64_t low_watermark) {
+        Version* keep = latest_version_;
+        if (!keep) return nullptr;
+        while (keep->prev_pointer_ && keep->prev_pointer_->end_timestamp_ >= low_watermark) {
+            keep = keep->prev_pointer_;
+        }
+        Version* tail = keep->prev_pointer_;
+        if (tail) {
+            __atomic_store_n(&keep->prev_pointer_, nullptr, __ATOMIC_RELEASE);
+        }
+        return tail;
+    }
+
+    // Versions kept for the record; the inline version counts only while the chain is empty
+    size_t chainLength() const {
+        size_t length = 0;
+        for (Version* version = latest_version_; version; version = version->prev_pointer_) {
+            ++length;
+        }
+        return length ? length : 1;
+    }
+
+    // Reads the version visible at timestamp: its image once committed, else
+    // nullopt with pending set to the placeholder to wait on. The common case,
+    // no newer version than the inline one, finds the image from the tuple's
+    // cache line without a chain walk.
+    std::optional<Payload> read(uint64_t timestamp, Version*& pending) const {
+        while (true) {
+            if (auto value = readInline(timestamp)) return value;
+            // an unfilled version of the reader's own timestamp is its own later write
+            Version* version = __atomic_load_n(&latest_version_, __ATOMIC_ACQUIRE);
+            while (version && (version->begin_timestamp_ > timestamp ||
+                               (version->begin_timestamp_ == timestamp && version->isPlaceholder()))) {
+                version = __atomic_load_n(&version->prev_pointer_, __ATOMIC_ACQUIRE);
+            }
+            if (version) {
+                if (!version->isPlaceholder()) return Payload(version->data_, payload_size_);
+                pending = version;
+                return std::nullopt;
+            }
+            // A placeholder is being linked in front of the inline version; retry
+        }
+    }
+
+    std::optional<Payload> getVersion(uint64_t timestamp) const {
+        Version* pending = nullptr;
+        return read(timestamp, pending);
+    }
+
+private:
+    // Inline committed version, valid for a reader at or after its timestamp
+    // unless a newer version is linked (head_begin_ beyond it). Writers
+    // serialize on the odd sequence number; readers retry around them.
+    std::optional<Payload> readInline(uint64_t timestamp) const {
+        while (true) {
+            uint64_t seq = __atomic_load_n(&seq_, __ATOMIC_ACQUIRE);
+            if (seq & 1) continue;
+            uint64_t committed = __atomic_load_n(&committed_timestamp_, __ATOMIC_RELAXED);
+            char* data = __atomic_load_n(&committed_data_, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&seq_, __ATOMIC_RELAXED) != seq) continue;
+            if (committed > timestamp ||
+                __atomic_load_n(&head_begin_, __ATOMIC_ACQUIRE) > committed) {
+                return std::nullopt;
+            }
+            return Payload(data, payload_size_);
+        }
+    }
+
+    void commitInline(uint64_t timestamp, char* data) {
+        uint64_t seq = __atomic_load_n(&seq_, __ATOMIC_RELAXED);
+        while (true) {
+            if (__atomic_load_n(&committed_timestamp_, __ATOMIC_RELAXED) >= timestamp) return;
+            if (!(seq & 1) && __atomic_compare_exchange_n(&seq_, &seq, seq + 1, false,
+                                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                break;
+            }
+            seq = __atomic_load_n(&seq_, __ATOMIC_RELAXED);
+        }
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        if (__atomic_load_n(&committed_timestamp_, __ATOMIC_RELAXED) < timestamp) {
+            __atomic_store_n(&committed_timestamp_, timestamp, __ATOMIC_RELAXED);
+            __atomic_store_n(&committed_data_, data, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&seq_, seq + 2, __ATOMIC_RELEASE);
+    }
+
+    uint64_t head_begin_;          // Begin timestamp of latest_version_
+    uint64_t seq_;                 // Odd while the inline version is being replaced
+    uint64_t committed_timestamp_; // Newest committed version, kept inline
+    char* committed_data_;         // Its image
+    uint32_t payload_size_;        // Bytes per image
+};
+
+static_assert(sizeof(Tuple) == 64, "a record is one cache line");
+
+using VersionArena = SlabArena<Tuple::Version>;
+
+#endif // TUPLE_HPP
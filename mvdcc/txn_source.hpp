@@ -0,0 +1,119 @@
+#ifndef TXN_SOURCE_HPP
+#define TXN_SOURCE_HPP
+
+#include "bounded_queue.hpp"
+#include "metrics.hpp"
+#include "workload.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Client Side of the Open-Loop Input Stage
+struct SourceConfig {
+    size_t client_num = 1;
+    double rate = 0.0;              // Offered Load in txn/s Over All Clients; 0 = As Fast as Possible
+    bool poisson = false;           // Exponential Instead of Fixed Inter-Arrival Times
+    uint64_t limit = 0;             // Transactions Issued in Total; 0 = Until Stopped
+    size_t queue_capacity = 65536;
+};
+
+// Transaction Source: Client Threads Feeding a Bounded Queue
+// Each client issues transactions on its own schedule. A transaction is
+// stamped with its intended arrival time, not with the time it got into the
+// queue, so a full queue shows up as latency instead of lowering the load.
+template <typename Txn>
+class TransactionSource {
+public:
+    TransactionSource() = default;
+    TransactionSource(const TransactionSource&) = delete;
+    TransactionSource& operator=(const TransactionSource&) = delete;
+    ~TransactionSource() { stop(); }
+
+    // make(FastRandom&, uint64_t sequence, uint64_t arrival_ns, Txn&) fills one transaction;
+    // sequence numbers are unique and dense, but reach the queue slightly out of order.
+    // Arrivals are scheduled from start_ns (nowNanos() time), the caller's measurement start.
+    template <typename Make>
+    void start(const SourceConfig& config, uint64_t seed, uint64_t start_ns, Make make) {
+        stop();
+        config_ = config;
+        queue_ = BoundedQueue<Txn>(config.queue_capacity);
+        stop_ = false;
+        issued_ = 0;
+        active_clients_ = config.client_num;
+        double interval_ns = config.rate > 0 ? 1e9 * config.client_num / config.rate : 0.0;
+        for (size_t i = 0; i < config.client_num; ++i) {
+            clients_.emplace_back([this, i, interval_ns, start_ns, seed, make] {
+                client(FastRandom(seed ^ (0x9e3779b97f4a7c15ULL * (i + 1))), interval_ns, start_ns, make);
+            });
+        }
+    }
+
+    void stop() {
+        __atomic_store_n(&stop_, true, __ATOMIC_RELEASE);
+        for (auto& client : clients_) client.join();
+        clients_.clear();
+    }
+
+    bool pop(Txn& txn) { return queue_.tryPop(txn); }
+
+    // Every client has finished and the queue is drained
+    bool exhausted() const {
+        return __atomic_load_n(&active_clients_, __ATOMIC_ACQUIRE) == 0 && queue_.empty();
+    }
+
+private:
+    template <typename Make>
+    void client(FastRandom rng, double interval_ns, uint64_t start_ns, Make make) {
+        double next_arrival = static_cast<double>(start_ns);
+        Txn txn;
+        while (!__atomic_load_n(&stop_, __ATOMIC_ACQUIRE)) {
+            uint64_t sequence = __atomic_fetch_add(&issued_, 1, __ATOMIC_RELAXED);
+            if (config_.limit && sequence >= config_.limit) break;
+
+            uint64_t arrival_ns = nowNanos();
+            if (interval_ns > 0) {
+                next_arrival += config_.poisson ? -std::log(1.0 - rng.nextDouble()) * interval_ns
+                                                : interval_ns;
+                arrival_ns = static_cast<uint64_t>(next_arrival);
+                if (!waitUntil(arrival_ns)) break;
+            }
+
+            make(rng, sequence, arrival_ns, txn);
+            if (!push(txn)) break;
+        }
+        __atomic_sub_fetch(&active_clients_, 1, __ATOMIC_RELEASE);
+    }
+
+    // Waits for room in the queue; false if stopped meanwhile
+    bool push(Txn& txn) {
+        while (!queue_.tryPush(txn)) {
+            if (__atomic_load_n(&stop_, __ATOMIC_ACQUIRE)) return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    // Sleeps off most of a long gap and spins the rest; false if stopped meanwhile
+    bool waitUntil(uint64_t deadline_ns) {
+        for (uint64_t now = nowNanos(); now < deadline_ns; now = nowNanos()) {
+            if (__atomic_load_n(&stop_, __ATOMIC_ACQUIRE)) return false;
+            if (deadline_ns - now > 200000) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(deadline_ns - now - 100000));
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        return true;
+    }
+
+    SourceConfig config_;
+    BoundedQueue<Txn> queue_;
+    std::vector<std::thread> clients_;
+    bool stop_ = false;
+    alignas(64) uint64_t issued_ = 0;
+    alignas(64) uint64_t active_clients_ = 0;
+};
+
+#endif // TXN_SOURCE_HPP
@@ -0,0 +1,117 @@
+#ifndef VERSION_ARENA_HPP
+#define VERSION_ARENA_HPP
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifndef PAGE_SIZE
+#define PAGE_SIZE 4096
+#endif
+#ifndef ARENA_SLAB_SIZE
+#define ARENA_SLAB_SIZE 65536      // Objects per arena slab
+#endif
+
+// Slab Arena: Bump Allocator for Objects Owned by a Single Thread
+// Retired objects are recycled once the epoch they were retired in is safe;
+// slabs themselves are only released with the arena. Slabs are fresh
+// anonymous mappings, so they are placed on the node of the thread that
+// first fills them rather than wherever recycled heap memory happens to live.
+// An object may be followed by trailing bytes (e.g. a version's payload):
+// every slot of the arena is object_size bytes, at least sizeof(T).
+template <typename T>
+class alignas(64) SlabArena {
+public:
+    explicit SlabArena(size_t slab_capacity = ARENA_SLAB_SIZE, size_t object_size = sizeof(T))
+        : slab_capacity_(slab_capacity),
+          stride_((std::max(object_size, sizeof(T)) + alignof(T) - 1) / alignof(T) * alignof(T)),
+          cursor_(nullptr), end_(nullptr) {}
+
+    SlabArena(SlabArena&& other) noexcept
+        : slabs_(std::move(other.slabs_)), retired_(std::move(other.retired_)),
+          free_(std::move(other.free_)), slab_capacity_(other.slab_capacity_),
+          stride_(other.stride_), cursor_(other.cursor_), end_(other.end_) {
+        other.cursor_ = other.end_ = nullptr;
+    }
+
+    SlabArena(const SlabArena&) = delete;
+    SlabArena& operator=(const SlabArena&) = delete;
+
+    ~SlabArena() {
+        for (auto slab : slabs_) munmap(slab.first, slab.second);
+    }
+
+    template <typename... Args>
+    T* allocate(Args&&... args) {
+        if (!free_.empty()) {
+            T* recycled = free_.back();
+            free_.pop_back();
+            return new (recycled) T(std::forward<Args>(args)...);
+        }
+        if (cursor_ == end_) refill(slab_capacity_);
+        void* slot = cursor_;
+        cursor_ += stride_;
+        return new (slot) T(std::forward<Args>(args)...);
+    }
+
+    // Hand back an unlinked object; it may still be read until safe_epoch >= epoch
+    void retire(T* object, uint64_t epoch) {
+        retired_.emplace_back(object, epoch);
+    }
+
+    // Recycle everything retired at or before safe_epoch (epochs retire in order)
+    size_t reclaim(uint64_t safe_epoch) {
+        size_t reclaimed = 0;
+        while (!retired_.empty() && retired_.front().second <= safe_epoch) {
+            free_.push_back(retired_.front().first);
+            retired_.pop_front();
+            ++reclaimed;
+        }
+        return reclaimed;
+    }
+
+    size_t retiredCount() const { return retired_.size(); }
+
+    // Free every slab at once; no object of the arena may be used afterwards
+    void release() {
+        for (auto slab : slabs_) munmap(slab.first, slab.second);
+        slabs_.clear();
+        retired_.clear();
+        free_.clear();
+        cursor_ = end_ = nullptr;
+    }
+
+    // Keep the next n fresh allocations contiguous (e.g. one batch)
+    void reserve(size_t n) {
+        if (static_cast<size_t>(end_ - cursor_) < n * stride_) {
+            refill(n > slab_capacity_ ? n : slab_capacity_);
+        }
+    }
+
+    size_t objectSize() const { return stride_; }
+
+private:
+    void refill(size_t n) {
+        void* slab = mmap(nullptr, n * stride_, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (slab == MAP_FAILED) throw std::bad_alloc();
+        slabs_.emplace_back(slab, n * stride_);
+        cursor_ = static_cast<char*>(slab);
+        end_ = cursor_ + n * stride_;
+    }
+
+    std::vector<std::pair<void*, size_t>> slabs_; // (mapping, bytes)
+    std::deque<std::pair<T*, uint64_t>> retired_; // (object, retire epoch)
+    std::vector<T*> free_;
+    size_t slab_capacity_;
+    size_t stride_;   // Bytes per object, trailing bytes included
+    char* cursor_;
+    char* end_;
+};
+
+#endif // VERSION_ARENA_HPP
@@ -0,0 +1,70 @@
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include <cstdint>
+#include <vector>
+
+// Chase-Lev Work-Stealing Deque of Pointers
+// The owner pushes and pops at the bottom; other threads steal from the top.
+// Capacity is fixed and must bound the number of items ever held at once.
+template <typename T>
+class alignas(64) WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        buffer_.assign(size, nullptr);
+        mask_ = size - 1;
+    }
+
+    // Owner Only
+    void push(T* item) {
+        int64_t bottom = __atomic_load_n(&bottom_, __ATOMIC_RELAXED);
+        __atomic_store_n(&buffer_[bottom & mask_], item, __ATOMIC_RELAXED);
+        __atomic_store_n(&bottom_, bottom + 1, __ATOMIC_RELEASE);
+    }
+
+    // Owner Only: Most Recently Pushed Item, or nullptr
+    T* pop() {
+        int64_t bottom = __atomic_load_n(&bottom_, __ATOMIC_RELAXED) - 1;
+        __atomic_store_n(&bottom_, bottom, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        int64_t top = __atomic_load_n(&top_, __ATOMIC_RELAXED);
+        if (top > bottom) {
+            __atomic_store_n(&bottom_, bottom + 1, __ATOMIC_RELAXED);
+            return nullptr;
+        }
+        T* item = __atomic_load_n(&buffer_[bottom & mask_], __ATOMIC_RELAXED);
+        if (top == bottom) {
+            // Last Item: Race Against Thieves
+            if (!__atomic_compare_exchange_n(&top_, &top, top + 1, false,
+                                             __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                item = nullptr;
+            }
+            __atomic_store_n(&bottom_, bottom + 1, __ATOMIC_RELAXED);
+        }
+        return item;
+    }
+
+    // Any Thread: Oldest Item, or nullptr if Empty or the Race Was Lost
+    T* steal() {
+        int64_t top = __atomic_load_n(&top_, __ATOMIC_ACQUIRE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        int64_t bottom = __atomic_load_n(&bottom_, __ATOMIC_ACQUIRE);
+        if (top >= bottom) return nullptr;
+        T* item = __atomic_load_n(&buffer_[top & mask_], __ATOMIC_RELAXED);
+        if (!__atomic_compare_exchange_n(&top_, &top, top + 1, false,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+private:
+    std::vector<T*> buffer_;
+    size_t mask_;
+    alignas(64) int64_t top_ = 0;
+    alignas(64) int64_t bottom_ = 0;
+};
+
+#endif // WORK_STEALING_DEQUE_HPP
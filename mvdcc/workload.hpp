@@ -0,0 +1,304 @@
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Fast Per-Thread PRNG (xoshiro256**), Seeded Through splitmix64
+class FastRandom {
+public:
+    explicit FastRandom(uint64_t seed = 1) {
+        for (auto& word : state_) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, bound) Without Division (Lemire's Multiply-Shift)
+    uint64_t nextBounded(uint64_t bound) {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+    }
+
+    // Uniform in [0, 1)
+    double nextDouble() { return (next() >> 11) * 0x1.0p-53; }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    uint64_t state_[4];
+};
+
+enum class KeyDistribution { UNIFORM, ZIPFIAN, HOTSPOT };
+
+inline KeyDistribution parseKeyDistribution(const std::string& name) {
+    if (name == "uniform") return KeyDistribution::UNIFORM;
+    if (name == "zipfian") return KeyDistribution::ZIPFIAN;
+    if (name == "hotspot") return KeyDistribution::HOTSPOT;
+    throw std::invalid_argument("unknown key distribution: " + name);
+}
+
+inline const char* keyDistributionName(KeyDistribution distribution) {
+    switch (distribution) {
+    case KeyDistribution::UNIFORM: return "uniform";
+    case KeyDistribution::ZIPFIAN: return "zipfian";
+    case KeyDistribution::HOTSPOT: return "hotspot";
+    }
+    return "unknown";
+}
+
+// Workload Parameters (YCSB-Style)
+struct WorkloadConfig {
+    KeyDistribution distribution = KeyDistribution::UNIFORM;
+    double theta = 0.99;            // Zipfian Skew, 0 < theta < 1
+    bool scramble = false;          // Spread Zipfian Hot Keys Over the Key Space
+    double hot_set_fraction = 0.2;  // Hotspot: Share of Keys That Are Hot
+    double hot_op_fraction = 0.8;   // Hotspot: Share of Accesses Going to Hot Keys
+    double read_ratio = 0.5;        // Share of Reads Among Non-RMW Operations
+    double rmw_ratio = 0.0;         // Share of Read-Modify-Write Operations
+    double scan_ratio = 0.0;        // Share of Range Scans
+    uint32_t scan_length = 100;     // Keys Covered by a Range Scan
+    double insert_ratio = 0.0;      // Share of Inserts of New Records
+    size_t min_ops = 10;            // Tasks per Transaction, Drawn Uniformly
+    size_t max_ops = 10;
+    uint64_t seed = 42;
+};
+
+// One Generated Task; a Read-Modify-Write Becomes a Read and a Write of One Key.
+// A Non-Zero range Makes It a Scan of the Keys [key, key + range); an Insert
+// Adds a New Record Next to key. Keys Are Ranks, Mapped to IDs by a KeySpace.
+struct WorkloadOp {
+    bool write;
+    uint64_t key;
+    uint32_t range = 0;
+    bool insert = false;
+};
+
+// Record IDs of a Table: the Record of Rank r Has ID id(r). Dense IDs Are the
+// Ranks Themselves. Sparse IDs Spread the Ranks Over the 64-Bit Key Space,
+// r << spread_bits Plus a Salt Below That, So They Keep the Ranks' Order but
+// Are Far Apart, and Inserted Records Land Between Them.
+class KeySpace {
+public:
+    static constexpr unsigned SPARSE_BITS = 20;
+
+    KeySpace(uint64_t tuple_num, bool sparse)
+        : tuple_num_(tuple_num), spread_bits_(sparse ? SPARSE_BITS : 0) {
+        if (sparse && tuple_num > (UINT64_MAX >> SPARSE_BITS)) {
+            throw std::invalid_argument("too many tuples for sparse keys");
+        }
+    }
+
+    uint64_t id(uint64_t rank) const {
+        return spread_bits_ ? rank << spread_bits_ | (salt(rank) & saltMask()) : rank;
+    }
+
+    // ID of a new record next to rank; unique says which insert it is. Dense
+    // IDs of new records follow the loaded ones. IDs may still repeat, e.g.
+    // a sparse salt, or a rerun inserting again; the protocol decides then.
+    uint64_t insertId(uint64_t rank, uint64_t unique) const {
+        if (!spread_bits_) return tuple_num_ + unique;
+        return rank << spread_bits_ | (salt(~unique) & saltMask());
+    }
+
+    // Width of the IDs of length consecutive ranks, as a scan covers them
+    uint64_t span(uint32_t length) const { return static_cast<uint64_t>(length) << spread_bits_; }
+
+    // Upper bound of the IDs of loaded records, for partitioning the key space
+    uint64_t bound() const { return spread_bits_ ? tuple_num_ << spread_bits_ : tuple_num_; }
+
+    bool sparse() const { return spread_bits_ != 0; }
+
+private:
+    uint64_t saltMask() const { return (uint64_t(1) << spread_bits_) - 1; }
+
+    static uint64_t salt(uint64_t value) {
+        value ^= value >> 31;
+        value *= 0x7fb5d329728ea185ULL;
+        value ^= value >> 27;
+        value *= 0x81dadef4bc2dd44dULL;
+        return value ^ (value >> 33);
+    }
+
+    uint64_t tuple_num_;
+    unsigned spread_bits_;
+};
+
+// Splits [0, count) Into One Contiguous Chunk per Thread
+template <typename Body>
+void parallelFor(size_t count, size_t thread_num, Body body) {
+    thread_num = std::max<size_t>(1, std::min(thread_num, count));
+    std::vector<std::thread> workers;
+    size_t chunk = (count + thread_num - 1) / thread_num;
+    for (size_t t = 0; t < thread_num; ++t) {
+        size_t begin = t * chunk;
+        size_t end = std::min(count, begin + chunk);
+        if (begin >= end) break;
+        workers.emplace_back(body, begin, end, t);
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+// Slots [0, count) Grouped by Owner: Group p Is slots_[begin_[p], begin_[p + 1]),
+// in Slot Order
+struct OwnerGroups {
+    std::unique_ptr<uint64_t[]> slots_;
+    std::vector<size_t> begin_;
+
+    std::span<const uint64_t> group(size_t p) const {
+        return {slots_.get() + begin_[p], begin_[p + 1] - begin_[p]};
+    }
+};
+
+// Groups the Slots by owner_of(slot) < owner_num in Two Parallel Passes: Every
+// Thread Counts the Owners in Its Chunk, Then Writes Its Slots to Their Groups
+template <typename OwnerOf>
+OwnerGroups groupByOwner(size_t count, size_t owner_num, size_t thread_num, OwnerOf owner_of) {
+    thread_num = std::max<size_t>(1, std::min(thread_num, count));
+    std::vector<std::vector<size_t>> offsets(thread_num, std::vector<size_t>(owner_num, 0));
+    parallelFor(count, thread_num, [&offsets, &owner_of](size_t begin, size_t end, size_t t) {
+        for (size_t slot = begin; slot < end; ++slot) offsets[t][owner_of(slot)]++;
+    });
+    // Counts Become Where Each Chunk Starts Writing Into Each Group
+    OwnerGroups groups;
+    groups.begin_.assign(owner_num + 1, 0);
+    size_t next = 0;
+    for (size_t p = 0; p < owner_num; ++p) {
+        groups.begin_[p] = next;
+        for (size_t t = 0; t < thread_num; ++t) {
+            size_t chunk_count = offsets[t][p];
+            offsets[t][p] = next;
+            next += chunk_count;
+        }
+    }
+    groups.begin_[owner_num] = next;
+    groups.slots_.reset(new uint64_t[count]);
+    uint64_t* slots = groups.slots_.get();
+    parallelFor(count, thread_num, [&offsets, &owner_of, slots](size_t begin, size_t end, size_t t) {
+        for (size_t slot = begin; slot < end; ++slot) slots[offsets[t][owner_of(slot)]++] = slot;
+    });
+    return groups;
+}
+
+// Key Generator for a Table of tuple_num Dense Keys
+// Shared, Read-Only State; Each Thread Passes Its Own FastRandom.
+class KeyGenerator {
+public:
+    KeyGenerator(const WorkloadConfig& config, uint64_t tuple_num, size_t thread_num)
+        : config_(config), tuple_num_(tuple_num) {
+        if (config.distribution == KeyDistribution::ZIPFIAN) {
+            if (!(config.theta > 0.0 && config.theta < 1.0)) {
+                throw std::invalid_argument("zipfian theta must be in (0, 1)");
+            }
+            zeta_n_ = zeta(tuple_num, config.theta, thread_num);
+            zeta_2_ = 1.0 + std::pow(0.5, config.theta);
+            alpha_ = 1.0 / (1.0 - config.theta);
+            eta_ = (1.0 - std::pow(2.0 / tuple_num, 1.0 - config.theta)) / (1.0 - zeta_2_ / zeta_n_);
+        }
+        hot_keys_ = std::max<uint64_t>(1, static_cast<uint64_t>(tuple_num * config.hot_set_fraction));
+    }
+
+    uint64_t next(FastRandom& rng) const {
+        switch (config_.distribution) {
+        case KeyDistribution::UNIFORM:
+            return rng.nextBounded(tuple_num_);
+        case KeyDistribution::ZIPFIAN: {
+            uint64_t rank = zipfRank(rng.nextDouble());
+            return config_.scramble ? scramble(rank) % tuple_num_ : rank;
+        }
+        case KeyDistribution::HOTSPOT:
+            if (rng.nextDouble() < config_.hot_op_fraction || hot_keys_ == tuple_num_) {
+                return rng.nextBounded(hot_keys_);
+            }
+            return hot_keys_ + rng.nextBounded(tuple_num_ - hot_keys_);
+        }
+        return 0;
+    }
+
+private:
+    // Gray et al., "Quickly Generating Billion-Record Synthetic Databases" (as in YCSB)
+    uint64_t zipfRank(double u) const {
+        double uz = u * zeta_n_;
+        if (uz < 1.0) return 0;
+        if (uz < zeta_2_) return 1;
+        uint64_t rank = static_cast<uint64_t>(tuple_num_ * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+        return std::min(rank, tuple_num_ - 1);
+    }
+
+    static double zeta(uint64_t n, double theta, size_t thread_num) {
+        std::vector<double> partial(std::max<size_t>(1, thread_num), 0.0);
+        parallelFor(n, thread_num, [&](size_t begin, size_t end, size_t t) {
+            double sum = 0.0;
+            for (size_t i = begin; i < end; ++i) sum += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+            partial[t] = sum;
+        });
+        double total = 0.0;
+        for (double sum : partial) total += sum;
+        return total;
+    }
+
+    static uint64_t scramble(uint64_t rank) {
+        uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a Over the Rank's Bytes
+        for (int i = 0; i < 8; ++i) {
+            hash ^= (rank >> (i * 8)) & 0xff;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    WorkloadConfig config_;
+    uint64_t tuple_num_;
+    double zeta_n_ = 0.0;
+    double alpha_ = 0.0;
+    double eta_ = 0.0;
+    double zeta_2_ = 0.0;
+    uint64_t hot_keys_ = 1;
+};
+
+// Draws the Tasks of One Transaction Into ops (Capacity max_ops); Returns the Count
+inline size_t generateOps(const WorkloadConfig& config, const KeyGenerator& keys,
+                          FastRandom& rng, WorkloadOp* ops) {
+    size_t target = config.min_ops;
+    if (config.max_ops > config.min_ops) {
+        target += rng.nextBounded(config.max_ops - config.min_ops + 1);
+    }
+    size_t count = 0;
+    while (count < target) {
+        uint64_t key = keys.next(rng);
+        double kind = rng.nextDouble();
+        if (kind < config.rmw_ratio && count + 2 <= config.max_ops) {
+            ops[count++] = {false, key};
+            ops[count++] = {true, key};
+        } else if (kind >= config.rmw_ratio && kind < config.rmw_ratio + config.scan_ratio) {
+            ops[count++] = {false, key, config.scan_length};
+        } else if (kind >= config.rmw_ratio + config.scan_ratio &&
+                   kind < config.rmw_ratio + config.scan_ratio + config.insert_ratio) {
+            ops[count++] = {true, key, 0, true};
+        } else {
+            ops[count++] = {rng.nextDouble() >= config.read_ratio, key};
+        }
+    }
+    return count;
+}
+
+#endif // WORKLOAD_HPP
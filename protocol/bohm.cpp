@@ -4,347 +4,1522 @@
 #include <atomic>
 #include <optional>
 #include <chrono>
+#include <fstream>
 #include <cassert>
 #include <algorithm>
+#include <cstring>
 #include <unordered_map>
-#include <mutex>
-#include <condition_variable>
-#include <queue>
 #include <functional> 
 
-#define PAGE_SIZE 4096
-#define DEFAULT_THREAD_NUM 8       // Default number of threads for debugging
-#define DEFAULT_TUPLE_NUM 1000     // Default number of records for debugging
+#include "../mvdcc/tuple.hpp"
+#include "../mvdcc/partitioner.hpp"
+#include "../mvdcc/work_stealing_deque.hpp"
+#include "../mvdcc/metrics.hpp"
+#include "../mvdcc/numa.hpp"
+#include "../mvdcc/workload.hpp"
+#include "../mvdcc/txn_source.hpp"
+#include "../mvdcc/command_log.hpp"
+#include "../mvdcc/snapshot.hpp"
+#include "../mvdcc/ordered_index.hpp"
+#include "../mvdcc/hash_index.hpp"
+#include "../mvdcc/bench.hpp"
+#include "../mvdcc/split_controller.hpp"
+
 #define MAX_OPE 10                 // Maximum operations per transaction
-#define EX_TIME 3                  // Execution time in seconds
-#define BATCH_SIZE 50              // Reduced batch size for debugging
-#define MAX_RETRY 10              // Max retries for failed transactions
+#define RING_SIZE 64               // Batches in flight between CC and execution
 
-uint64_t tx_counter = 0;           // Global transaction counter
+// Pipelined BOHM, run by the benchmark driver through runBohm(). Everything
+// lives in its own namespace because the mvdcc protocols linked into the
+// same binary define their own Table, Transaction, etc.
+namespace pipeline {
 
-class Result {
-public:
-    uint64_t commit_cnt_ = 0; // Count of committed transactions
-};
+uint64_t tx_counter = 0;           // Next timestamp to sequence; 0 is the initial load
+size_t partition_count = 0;        // Record partitions, each handled by one CC thread per batch
+size_t batch_size = 1;             // Transactions per batch, set per run
+size_t payload_size = 0;           // Bytes per record image, set per run
+uint64_t batch_timeout_ns = 0;     // A partial batch is cut this long after its first transaction
 
-std::vector<Result> AllResult;
+std::vector<Result> AllResult;     // Per-thread counters and latencies
 
-enum class Ope { READ, WRITE };
+// An INSERT creates its record, or writes it if the key already exists; a
+// WRITE of a key that does not exist does nothing
+enum class Ope : uint8_t { READ, WRITE, SCAN, INSERT };
 
 class Task {
 public:
     Ope ope_;
+    uint64_t range_; // SCAN: reads every record with a key in [key_, key_ + range_)
     uint64_t key_;
 
-    Task(Ope ope, uint64_t key) : ope_(ope), key_(key) {}
+    Task(Ope ope, uint64_t key, uint64_t range = 0) : ope_(ope), range_(range), key_(key) {}
+    Task() : ope_(Ope::READ), range_(0), key_(0) {}
 };
 
-class Tuple {
-public:
-    struct Version {
-        uint64_t begin_timestamp_;
-        uint64_t end_timestamp_;
-        uint64_t value_;
-        bool placeholder_;
-        Version* prev_pointer_;
-
-        Version(uint64_t begin, uint64_t end, uint64_t value, bool placeholder, Version* prev)
-            : begin_timestamp_(begin), end_timestamp_(end), value_(value),
-              placeholder_(placeholder), prev_pointer_(prev) {}
+// Records are found by key through the primary index, any thread without
+// locks, and in key order through the ordered index of each partition, which
+// scans resolve their records with. Only the CC thread handling a key's
+// partition enters it, in both. Loaded records with dense keys are not in the
+// primary index: findRecord() addresses them in Table by key.
+HashIndex<Tuple*> primary;
+std::vector<OrderedIndex<Tuple*>> indexes;
+
+// A record found by a scan, with the version it reads: the newest one when
+// the scan was resolved, pending or committed, or nullptr if the record had
+// only its initial image. image_ is set once the execution phase has read it.
+struct ScanEntry {
+    uint64_t key_;
+    Tuple* tuple_;
+    Tuple::Version* version_;
+    const char* image_;
+};
+
+// Visits the entries of a scan in key order: parts holds the records each
+// partition contributed, each part sorted by key. A heap of the parts keyed
+// by their first records merges them in O(log parts) per record; the last
+// part left is visited straight through. Consumes parts.
+template <typename Visit>
+void visitInKeyOrder(std::vector<std::span<const ScanEntry>>& parts, Visit visit) {
+    std::erase_if(parts, [](std::span<const ScanEntry> part) { return part.empty(); });
+    auto later = [](std::span<const ScanEntry> a, std::span<const ScanEntry> b) {
+        return a.front().key_ > b.front().key_;
     };
+    std::make_heap(parts.begin(), parts.end(), later);
+    while (parts.size() > 1) {
+        std::pop_heap(parts.begin(), parts.end(), later);
+        std::span<const ScanEntry>& part = parts.back();
+        visit(part.front());
+        part = part.subspan(1);
+        if (part.empty()) {
+            parts.pop_back();
+        } else {
+            std::push_heap(parts.begin(), parts.end(), later);
+        }
+    }
+    if (!parts.empty()) {
+        for (const ScanEntry& entry : parts.back()) visit(entry);
+        parts.clear();
+    }
+}
+
+Tuple* Table;                        // Records loaded at startup, by slot
+PageArray<Tuple> table_pages;        // Backs Table
+uint64_t dense_records = 0;          // Keys below it are loaded records, at Table[key]
+PageArray<char> image_pages;         // Initial record images
+std::vector<VersionArena> cc_arenas; // Versions created in each partition
+std::vector<SlabArena<Tuple>> tuple_arenas; // Records inserted in each partition
+
+// The record with key, nullptr if there is none. A dense key of a loaded
+// record is its slot, so only other keys, of inserted records, sparse ones
+// or a snapshot's, pay for a probe of the primary index.
+Tuple* findRecord(uint64_t key) {
+    if (key < dense_records) return &Table[key];
+    return primary.find(key);
+}
+
+enum class Status { UNPROCESSED, EXECUTING, COMMITTED };
+
+// A transaction as submitted by a client. Fixed size and free of heap
+// memory, so the client queue hands it over with a plain copy.
+struct Request {
+    uint64_t arrival_ns_ = 0;   // intended arrival at the client
+    uint32_t task_num_ = 0;
+    Task task_set_[MAX_OPE];
+};
+
+class Batch;
+
+// Execution state of a sequenced transaction; its tasks and versions live in
+// its batch. A transaction blocked on a placeholder waits in that version's
+// waiter list.
+class Transaction : public VersionWaiter {
+public:
+    Batch* batch_ = nullptr;
+    uint32_t index_ = 0;       // position in the batch
+    uint32_t resume_task_ = 0; // first task not yet executed
+    uint32_t scan_read_ = 0;   // records of the scan at resume_task_ already read
+    uint64_t exec_ns_ = 0;     // time spent running, excluding deferrals
+    uint64_t digest_ = 0;      // folded over the images read, so reads are not optimized away
+    Status status_ = Status::UNPROCESSED;
+
+    void startExecution() {
+        status_ = Status::EXECUTING;
+    }
+
+    void commit() {
+        status_ = Status::COMMITTED;
+    }
+};
+
+// One batch, stored struct-of-arrays: the CC threads scan the operations and
+// keys of every transaction and fill in the versions, the execution threads
+// work on the per-transaction state. Every ring slot owns one batch, sized
+// for batch_size per run and refilled in place, so nothing is copied or
+// allocated per transaction once the sequencer has admitted it. The records
+// of a scan are found in every partition; the CC thread handling a partition
+// appends them to the partition's part of the batch, the scans in batch order.
+class Batch {
+public:
+    void init(size_t capacity, size_t partition_num) {
+        capacity_ = capacity;
+        size_ = 0;
+        scan_num_ = 0;
+        task_num_.assign(capacity, 0);
+        arrival_ns_.assign(capacity, 0);
+        opes_.assign(capacity * MAX_OPE, Ope::READ);
+        keys_.assign(capacity * MAX_OPE, 0);
+        ranges_.assign(capacity * MAX_OPE, 0);
+        scan_ids_.assign(capacity * MAX_OPE, 0);
+        versions_.assign(capacity * MAX_OPE, nullptr);
+        scan_entries_.assign(partition_num, {});
+        scan_ends_.assign(partition_num, {});
+        txns_ = std::vector<Transaction>(capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            txns_[i].batch_ = this;
+            txns_[i].index_ = i;
+        }
+    }
+
+    // Sequencer: empties the batch for batch_id, whose first transaction gets first_timestamp
+    void reset(uint64_t batch_id, uint64_t first_timestamp) {
+        id_ = batch_id;
+        first_timestamp_ = first_timestamp;
+        size_ = 0;
+        scan_num_ = 0;
+    }
+
+    // Sequencer: admits a request; its versions are filled by the CC threads
+    void append(const Request& request) {
+        size_t i = size_++;
+        task_num_[i] = request.task_num_;
+        arrival_ns_[i] = request.arrival_ns_;
+        for (uint32_t j = 0; j < request.task_num_; ++j) {
+            const Task& task = request.task_set_[j];
+            opes_[i * MAX_OPE + j] = task.ope_;
+            keys_[i * MAX_OPE + j] = task.key_;
+            ranges_[i * MAX_OPE + j] = task.range_;
+            if (task.ope_ == Ope::SCAN) scan_ids_[i * MAX_OPE + j] = scan_num_++;
+        }
+        Transaction& trans = txns_[i];
+        trans.next_waiter_ = nullptr;
+        trans.resume_task_ = 0;
+        trans.scan_read_ = 0;
+        trans.exec_ns_ = 0;
+        trans.digest_ = 0;
+        trans.status_ = Status::UNPROCESSED;
+    }
+
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == capacity_; }
+    size_t size() const { return size_; }
+    uint64_t id() const { return id_; }
+    uint64_t firstTimestamp() const { return first_timestamp_; }
+
+    // Transactions are timestamped consecutively in batch order
+    uint64_t timestamp(size_t i) const { return first_timestamp_ + i; }
+    uint64_t arrival(size_t i) const { return arrival_ns_[i]; }
+    size_t taskNum(size_t i) const { return task_num_[i]; }
+    Ope ope(size_t i, size_t j) const { return opes_[i * MAX_OPE + j]; }
+    uint64_t key(size_t i, size_t j) const { return keys_[i * MAX_OPE + j]; }
+    uint64_t range(size_t i, size_t j) const { return ranges_[i * MAX_OPE + j]; }
+    Tuple::Version*& version(size_t i, size_t j) { return versions_[i * MAX_OPE + j]; }
+    Transaction& transaction(size_t i) { return txns_[i]; }
+
+    // The CC threads the batch is split over: partition p goes to thread
+    // p % ccThreads(). repartitioned() if the previous batch was split otherwise.
+    // Workers may look at the split of a batch that is being recycled.
+    size_t ccThreads() const { return __atomic_load_n(&cc_threads_, __ATOMIC_RELAXED); }
+    bool repartitioned() const { return repartitioned_; }
+    void split(size_t cc_threads, bool repartitioned) {
+        __atomic_store_n(&cc_threads_, cc_threads, __ATOMIC_RELAXED);
+        repartitioned_ = repartitioned;
+    }
+
+    // Partition p's part of the records of every scan, filled scan by scan;
+    // endScan() closes the part of the current scan
+    std::vector<ScanEntry>& scanEntries(size_t p) { return scan_entries_[p]; }
+    void beginScans(size_t p) {
+        scan_entries_[p].clear();
+        scan_ends_[p].clear();
+    }
+    void endScan(size_t p) { scan_ends_[p].push_back(scan_entries_[p].size()); }
+
+    // The records partition p holds for the scan of task j of transaction i
+    std::span<ScanEntry> scanPart(size_t p, size_t i, size_t j) {
+        uint32_t scan_id = scan_ids_[i * MAX_OPE + j];
+        const std::vector<uint32_t>& ends = scan_ends_[p];
+        uint32_t begin = scan_id ? ends[scan_id - 1] : 0;
+        return {scan_entries_[p].data() + begin, ends[scan_id] - begin};
+    }
+
+private:
+    uint64_t id_ = 0;
+    uint64_t first_timestamp_ = 0;
+    size_t cc_threads_ = 1;
+    bool repartitioned_ = false;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    uint32_t scan_num_ = 0;
+    std::vector<uint8_t> task_num_;
+    std::vector<uint64_t> arrival_ns_;
+    // Per task, MAX_OPE entries per transaction
+    std::vector<Ope> opes_;
+    std::vector<uint64_t> keys_;
+    std::vector<uint64_t> ranges_;
+    std::vector<uint32_t> scan_ids_;        // A scan's position among the scans of the batch
+    std::vector<Tuple::Version*> versions_; // Read or placeholder version, set by the owning CC thread
+    std::vector<Transaction> txns_;
+    // Per partition
+    std::vector<std::vector<ScanEntry>> scan_entries_;
+    std::vector<std::vector<uint32_t>> scan_ends_; // End of each scan's records in scan_entries_
+};
+
+// Static partitioning: every partition holds a fixed set of records; the
+// split of each batch says which CC thread handles it
+Partitioner partitioner;
+
+// Assigns records to the partitions of the CC phase; key_bound is where the
+// keys of the loaded records end, records inserted later fall into the same partitions
+void assignRecordsToCCThreads(size_t partition_num, uint64_t key_bound, PartitionStrategy strategy) {
+    partitioner.build(strategy, partition_num, key_bound);
+}
+
+// Debugging function to display record distribution
+void debugRecordDistribution(size_t partition_num) {
+    for (size_t p = 0; p < partition_num; ++p) {
+        std::cout << "[DEBUG] Partition " << p << " assigned records ("
+                  << partitionStrategyName(partitioner.strategy()) << "): ";
+        indexes[p].scan(0, UINT64_MAX, [](uint64_t key, Tuple*) { std::cout << key << " "; });
+        std::cout << std::endl;
+    }
+}
+
+// Visits every record, inserted ones included, partition by partition
+template <typename Visit>
+void forEachRecord(Visit visit) {
+    for (const OrderedIndex<Tuple*>& index : indexes) index.scan(0, UINT64_MAX, visit);
+}
 
-    Version* latest_version_;
+// Unlinks obsolete versions of a record of partition p. Readers that were
+// already walking the chain may still hold them, so they are only recycled
+// once every transaction sequenced so far has finished.
+void collectGarbage(size_t p, Tuple& tuple, uint64_t low_watermark) {
+    Tuple::Version* version = tuple.pruneVersions(low_watermark);
+    if (!version) return;
+    uint64_t epoch = __atomic_load_n(&tx_counter, __ATOMIC_ACQUIRE);
+    while (version) {
+        Tuple::Version* prev = version->prev_pointer_;
+        cc_arenas[p].retire(version, epoch);
+        version = prev;
+    }
+}
+
+// Average number of versions per record, used to check that GC keeps chains flat
+double averageChainLength() {
+    uint64_t total = 0;
+    uint64_t record_num = 0;
+    forEachRecord([&](uint64_t, Tuple* tuple) {
+        total += tuple->chainLength();
+        record_num++;
+    });
+    return record_num ? static_cast<double>(total) / record_num : 0.0;
+}
+
+TransactionSource<Request> txn_source;
+
+// Batch pipeline between the sequencer, the CC threads and the execution threads.
+// Batch b lives in slot b % RING_SIZE and moves FREE -> SEQUENCED -> READY -> DONE:
+// the sequencer publishes it to the CC threads of its split, the last CC
+// thread to finish its partitions releases it to execution, and the last
+// executed transaction marks it done. Done batches are retired in batch order, which frees the slot
+// for batch b + RING_SIZE and advances the low watermark. Execution threads
+// claim transactions through one global cursor, so claims follow timestamp
+// order and the CC threads are already working on later batches while earlier
+// ones execute. Batches may be of any non-zero size up to batch_size and are
+// filled in place in their slot. A batch only executes once its inputs are
+// durable, so no effect of a transaction is visible before it can be replayed.
+class BatchRing {
+public:
+    enum Phase : uint32_t { FREE, SEQUENCED, READY, DONE };
+
+    // Empties the ring for a new run whose first batch starts at first_timestamp
+    // and is split over cc_threads CC threads
+    void init(size_t partition_num, size_t cc_threads, size_t batch_capacity, uint64_t first_timestamp) {
+        cc_threads_ = cc_threads;
+        cursor_ = 0;
+        low_batch_ = 0;
+        low_watermark_ = first_timestamp;
+        completed_ = 0;
+        sequenced_ = 0;
+        ready_ = 0;
+        durable_ = 0;
+        for (uint64_t i = 0; i < RING_SIZE; ++i) {
+            slots_[i].batch_id_ = i;
+            slots_[i].phase_ = FREE;
+            slots_[i].batch_.init(batch_capacity, partition_num);
+        }
+    }
+
+    // Sequencer: waits for the slot to be free and hands out its batch, emptied
+    // for refilling; nullptr on quit
+    Batch* acquire(uint64_t batch_id, uint64_t first_timestamp, const bool& quit) {
+        Slot& slot = slots_[batch_id % RING_SIZE];
+        if (!await(slot, batch_id, FREE, quit)) return nullptr;
+        slot.batch_.reset(batch_id, first_timestamp);
+        return &slot.batch_;
+    }
+
+    // Sequencer: publishes the filled batch to the first cc_threads workers
+    void sequence(uint64_t batch_id, size_t cc_threads) {
+        Slot& slot = slots_[batch_id % RING_SIZE];
+        slot.batch_.split(cc_threads, cc_threads != cc_threads_);
+        cc_threads_ = cc_threads;
+        slot.cc_done_ = 0;
+        slot.finished_ = 0;
+        __atomic_store_n(&slot.phase_, SEQUENCED, __ATOMIC_RELEASE);
+        __atomic_store_n(&sequenced_, batch_id + 1, __ATOMIC_RELEASE);
+    }
+
+    // Workers: the batch once it has been sequenced, nullptr before, with the
+    // number of its CC threads in cc_threads. That is 0 if the batch already
+    // went through its CC phase and its slot was recycled, which it cannot
+    // have with the caller among its CC threads.
+    Batch* sequenced(uint64_t batch_id, size_t& cc_threads) {
+        Slot& slot = slots_[batch_id % RING_SIZE];
+        uint64_t slot_batch = __atomic_load_n(&slot.batch_id_, __ATOMIC_ACQUIRE);
+        if (slot_batch < batch_id) return nullptr;
+        if (slot_batch == batch_id) {
+            if (__atomic_load_n(&slot.phase_, __ATOMIC_ACQUIRE) == FREE) return nullptr;
+            cc_threads = slot.batch_.ccThreads();
+            // recycled while being looked at: the count may be the next batch's
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot.batch_id_, __ATOMIC_RELAXED) == batch_id) return &slot.batch_;
+        }
+        cc_threads = 0;
+        return &slot.batch_;
+    }
+
+    // Whether every partition of the batch is through the CC phase
+    bool ccFinished(uint64_t batch_id) const {
+        const Slot& slot = slots_[batch_id % RING_SIZE];
+        return __atomic_load_n(&slot.batch_id_, __ATOMIC_ACQUIRE) != batch_id ||
+               __atomic_load_n(&slot.phase_, __ATOMIC_ACQUIRE) >= READY;
+    }
 
-    Tuple() {
-        latest_version_ = new Version(0, UINT64_MAX, 0, false, nullptr);
+    // Batches 0 .. batch_count-1 are durable (logged, or no log is kept)
+    void persist(uint64_t batch_count) {
+        __atomic_store_n(&durable_, batch_count, __ATOMIC_RELEASE);
     }
 
-    void addPlaceholder(uint64_t timestamp) {
-        auto new_version = new Version(timestamp, UINT64_MAX, 0, true, latest_version_);
-        if (latest_version_) {
-            latest_version_->end_timestamp_ = timestamp;
+    // CC threads: barrier at the end of the CC phase of a batch
+    void finishCC(uint64_t batch_id) {
+        Slot& slot = slots_[batch_id % RING_SIZE];
+        if (__atomic_add_fetch(&slot.cc_done_, 1, __ATOMIC_ACQ_REL) == slot.batch_.ccThreads()) {
+            slot.released_ns_ = nowNanos();
+            uint64_t ready = __atomic_load_n(&ready_, __ATOMIC_RELAXED);
+            while (ready < batch_id + 1 &&
+                   !__atomic_compare_exchange_n(&ready_, &ready, batch_id + 1, false,
+                                                __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {}
+            __atomic_store_n(&slot.phase_, READY, __ATOMIC_RELEASE);
         }
-        latest_version_ = new_version;
     }
 
-    bool updatePlaceholder(uint64_t timestamp, uint64_t value) {
-        Version* version = latest_version_;
-        while (version) {
-            if (version->begin_timestamp_ == timestamp && version->placeholder_) {
-                version->value_ = value;
-                version->placeholder_ = false;
-                return true;
+    // Claims the next transaction in timestamp order without waiting;
+    // nullptr if its batch is not released or not durable yet. The cursor packs the batch
+    // id (high 32 bits) and the position within the batch (low 32 bits).
+    Transaction* tryClaim() {
+        uint64_t cursor = __atomic_load_n(&cursor_, __ATOMIC_ACQUIRE);
+        while (true) {
+            uint64_t batch_id = cursor >> 32;
+            uint64_t index = cursor & 0xffffffff;
+            Slot& slot = slots_[batch_id % RING_SIZE];
+            if (__atomic_load_n(&slot.batch_id_, __ATOMIC_ACQUIRE) != batch_id ||
+                __atomic_load_n(&slot.phase_, __ATOMIC_ACQUIRE) != READY ||
+                __atomic_load_n(&durable_, __ATOMIC_ACQUIRE) <= batch_id) {
+                return nullptr;
             }
-            version = version->prev_pointer_;
+            // the claimer of the last position moves the cursor to the next batch
+            uint64_t next = index + 1 < slot.batch_.size() ? cursor + 1 : (batch_id + 1) << 32;
+            // a batch is only recycled after all its positions were claimed,
+            // so winning the CAS proves the slot still holds batch_id
+            if (__atomic_compare_exchange_n(&cursor_, &cursor, next, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                return &slot.batch_.transaction(index);
+            }
+        }
+    }
+
+    // When the batch was released to execution; valid while it is being executed
+    uint64_t releasedAt(uint64_t batch_id) const {
+        return slots_[batch_id % RING_SIZE].released_ns_;
+    }
+
+    // The last finisher of a batch marks it done and retires every done batch
+    // at the head of the ring. The size is read first: once the count is in,
+    // the last finisher may retire the slot and the sequencer refill it.
+    void complete(uint64_t batch_id) {
+        Slot& slot = slots_[batch_id % RING_SIZE];
+        size_t size = slot.batch_.size();
+        if (__atomic_add_fetch(&slot.finished_, 1, __ATOMIC_ACQ_REL) == size) {
+            __atomic_store_n(&slot.phase_, DONE, __ATOMIC_RELEASE);
+            retire();
+        }
+    }
+
+    // First timestamp after the retired batches: every transaction before it
+    // has executed, so versions that ended before it are invisible to every
+    // transaction still running, and the state just before it is fully
+    // written. Never decreases.
+    uint64_t lowWatermark() const { return __atomic_load_n(&low_watermark_, __ATOMIC_SEQ_CST); }
+
+    // Transactions of all retired batches
+    uint64_t completedCount() const { return __atomic_load_n(&completed_, __ATOMIC_ACQUIRE); }
+
+    // Batches that may execute, through the CC phase and durable, and
+    // batches retired; the ones in between wait for execution
+    uint64_t releasedBatches() const {
+        return std::min(__atomic_load_n(&ready_, __ATOMIC_ACQUIRE), __atomic_load_n(&durable_, __ATOMIC_ACQUIRE));
+    }
+    uint64_t retiredBatches() const { return __atomic_load_n(&low_batch_, __ATOMIC_ACQUIRE); }
+
+    // Batches handed out by the sequencer, and to the command log if one is kept
+    uint64_t sequencedBatches() const { return __atomic_load_n(&sequenced_, __ATOMIC_ACQUIRE); }
+
+private:
+    struct alignas(64) Slot {
+        uint64_t batch_id_ = 0;
+        uint32_t phase_ = FREE;
+        uint64_t cc_done_ = 0;
+        uint64_t finished_ = 0;
+        uint64_t released_ns_ = 0;
+        Batch batch_;
+    };
+
+    bool await(Slot& slot, uint64_t batch_id, Phase phase, const bool& quit) {
+        while (__atomic_load_n(&slot.batch_id_, __ATOMIC_ACQUIRE) != batch_id ||
+               __atomic_load_n(&slot.phase_, __ATOMIC_ACQUIRE) != phase) {
+            if (__atomic_load_n(&quit, __ATOMIC_ACQUIRE)) return false;
+            std::this_thread::yield();
         }
-        return false;
+        return true;
     }
 
-    std::optional<uint64_t> getVersion(uint64_t timestamp) {
-        Version* version = latest_version_;
-        while (version) {
-            if (version->begin_timestamp_ <= timestamp && timestamp < version->end_timestamp_ && !version->placeholder_) {
-                return version->value_;
+    // Whoever moves low_batch_ past a done batch frees its slot
+    void retire() {
+        uint64_t batch_id = __atomic_load_n(&low_batch_, __ATOMIC_ACQUIRE);
+        while (true) {
+            Slot& slot = slots_[batch_id % RING_SIZE];
+            if (__atomic_load_n(&slot.batch_id_, __ATOMIC_ACQUIRE) != batch_id ||
+                __atomic_load_n(&slot.phase_, __ATOMIC_ACQUIRE) != DONE) {
+                return;
+            }
+            if (!__atomic_compare_exchange_n(&low_batch_, &batch_id, batch_id + 1, false,
+                                             __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                continue;
             }
-            version = version->prev_pointer_;
+            __atomic_add_fetch(&completed_, slot.batch_.size(), __ATOMIC_RELEASE);
+            // retirers of consecutive batches may get here out of order
+            uint64_t end = slot.batch_.firstTimestamp() + slot.batch_.size();
+            uint64_t watermark = __atomic_load_n(&low_watermark_, __ATOMIC_RELAXED);
+            while (watermark < end &&
+                   !__atomic_compare_exchange_n(&low_watermark_, &watermark, end, false,
+                                                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {}
+            // phase first: whoever observes the new batch id must also see FREE
+            __atomic_store_n(&slot.phase_, FREE, __ATOMIC_RELAXED);
+            __atomic_store_n(&slot.batch_id_, batch_id + RING_SIZE, __ATOMIC_RELEASE);
+            ++batch_id;
         }
-        return std::nullopt;
     }
+
+    Slot slots_[RING_SIZE];
+    size_t cc_threads_ = 1;               // split of the last sequenced batch
+    alignas(64) uint64_t cursor_ = 0;
+    alignas(64) uint64_t low_batch_ = 0;
+    uint64_t low_watermark_ = 1;
+    alignas(64) uint64_t completed_ = 0;
+    uint64_t sequenced_ = 0;              // written by the sequencer only
+    alignas(64) uint64_t ready_ = 0;      // batches through the CC phase
+    alignas(64) uint64_t durable_ = 0;    // batches whose inputs are durable
 };
 
-Tuple* Table;
+BatchRing batch_ring;
 
-enum class Status { UNPROCESSED, EXECUTING, COMMITTED };
+SplitController split;
 
-class Transaction {
+// Snapshots of the readers outside the pipeline: read-only transactions and
+// the checkpointer, one slot each. A reader reads the state just before the
+// low watermark, so it never meets a placeholder, and the CC threads prune
+// nothing it may still reach until it leaves. A reader publishes its snapshot
+// and then checks that the watermark has not moved on meanwhile; a CC thread
+// that missed the publication read its own watermark earlier, and watermarks
+// only grow, so it cannot have gone past the reader's snapshot either.
+class SnapshotRegistry {
 public:
-    uint64_t timestamp_;
-    Status status_;
-    std::vector<Task> task_set_;
-    std::vector<std::pair<uint64_t, uint64_t>> read_set_;
-    std::vector<uint64_t> write_set_;
+    void init(size_t slot_num) { slots_ = std::vector<Slot>(slot_num); }
 
-    Transaction(uint64_t timestamp)
-        : timestamp_(timestamp), status_(Status::UNPROCESSED) {}
+    // Returns the snapshot timestamp: the reader sees every transaction before it
+    uint64_t enter(size_t slot) {
+        uint64_t timestamp = batch_ring.lowWatermark();
+        while (true) {
+            __atomic_store_n(&slots_[slot].timestamp_, timestamp, __ATOMIC_SEQ_CST);
+            uint64_t current = batch_ring.lowWatermark();
+            if (current == timestamp) return timestamp;
+            timestamp = current;
+        }
+    }
 
-    Transaction()
-        : timestamp_(0), status_(Status::UNPROCESSED) {}
+    void exit(size_t slot) { __atomic_store_n(&slots_[slot].timestamp_, IDLE, __ATOMIC_RELEASE); }
 
-    void startExecution() {
-        status_ = Status::EXECUTING;
+    // CC threads: the oldest snapshot in use, IDLE if none; read after the ring's watermark
+    uint64_t oldest() const {
+        uint64_t oldest = IDLE;
+        for (const Slot& slot : slots_) {
+            oldest = std::min(oldest, __atomic_load_n(&slot.timestamp_, __ATOMIC_SEQ_CST));
+        }
+        return oldest;
     }
 
-    void commit() {
-        read_set_.clear();
-        write_set_.clear();
-        status_ = Status::COMMITTED;
-    }
+private:
+    static constexpr uint64_t IDLE = UINT64_MAX;
+
+    struct alignas(64) Slot {
+        uint64_t timestamp_ = IDLE;
+    };
+
+    std::vector<Slot> slots_;
 };
 
-// Static partitioning: Each thread owns a set of records
-std::vector<std::vector<uint64_t>> thread_partitions;
+SnapshotRegistry snapshots;
+CommandLog command_log; // open while the run logs its batches
+MappedSnapshot snapshot; // initial images when started from a snapshot
+uint64_t first_timestamp = 1; // of the first batch; a snapshot's state precedes it
 
-// Assigns records only to CC phase threads
-void assignRecordsToCCThreads(size_t cc_thread_num, size_t tuple_num) {
-    thread_partitions.resize(cc_thread_num);
-    for (uint64_t i = 0; i < tuple_num; ++i) {
-        int thread_id = i % cc_thread_num;
-        thread_partitions[thread_id].push_back(i);
+// Constructs the database table of record_num loaded records in fresh pages,
+// dropping the one of a previous run. Slot i holds the record with key
+// key_of(i), key i if dense; load(i) constructs its tuple, which is then
+// entered in the ordered indexes, and in the primary one unless dense. The
+// primary index is sized for the rest of expected_num records.
+// With a pinned placement worker p first-touches the records of partition p
+// and builds its ordered index, so both end up on the node of the worker
+// handling the partition under a fixed split; this needs the partition first.
+// Otherwise load_thread_num threads construct one contiguous chunk of tuples
+// each, then every partition's ordered index is built by a thread of its own.
+// A partition's slots are enumerated directly for dense keys under a modulo
+// or range partition, and grouped by partition in a parallel pass otherwise,
+// so no thread looks at every slot. Initial versions are the tuples' inline
+// ones, so nothing is allocated per record.
+template <typename KeyOf, typename Load>
+void buildTable(size_t record_num, size_t expected_num, const ThreadPlacement& placement,
+                size_t partition_num, size_t load_thread_num, bool huge_pages, bool dense,
+                KeyOf key_of, Load load) {
+    Table = table_pages.allocate(record_num, huge_pages);
+    dense_records = dense ? record_num : 0;
+    size_t primary_num = dense ? expected_num - std::min(expected_num, record_num)
+                               : std::max(record_num, expected_num);
+    primary.reset(primary_num, huge_pages);
+    indexes = std::vector<OrderedIndex<Tuple*>>(partition_num);
+    bool direct = dense && partitioner.enumerable();
+    OwnerGroups groups;
+    if (!direct) {
+        groups = groupByOwner(record_num, partition_num, load_thread_num,
+                              [&key_of](uint64_t slot) { return partitioner.owner(key_of(slot)); });
+    }
+    auto forEachSlot = [direct, record_num, &groups](size_t p, auto visit) {
+        if (direct) {
+            partitioner.forEachOwned(p, record_num, visit);
+            return;
+        }
+        for (uint64_t slot : groups.group(p)) visit(slot);
+    };
+    if (placement.pinned()) {
+        runPinned(placement, partition_num, [&forEachSlot, &key_of, &load, dense](size_t p) {
+            forEachSlot(p, [p, &key_of, &load, dense](uint64_t slot) {
+                uint64_t key = key_of(slot);
+                load(slot);
+                if (!dense) primary.insert(key, &Table[slot]);
+                indexes[p].insert(key, &Table[slot]);
+            });
+        });
+        return;
     }
+    parallelFor(record_num, load_thread_num, [&key_of, &load, dense](size_t begin, size_t end, size_t) {
+        for (size_t slot = begin; slot < end; ++slot) {
+            load(slot);
+            if (!dense) primary.insert(key_of(slot), &Table[slot]);
+        }
+    });
+    runPinned(placement, partition_num, [&forEachSlot, &key_of](size_t p) {
+        forEachSlot(p, [p, &key_of](uint64_t slot) { indexes[p].insert(key_of(slot), &Table[slot]); });
+    });
 }
 
-// Debugging function to display record distribution
-void debugRecordDistribution(size_t cc_thread_num) {
-    for (size_t thread_id = 0; thread_id < cc_thread_num; ++thread_id) {
-        std::cout << "[DEBUG] CC Thread " << thread_id << " assigned records: ";
-        for (const auto& record : thread_partitions[thread_id]) {
-            std::cout << record << " ";
-        }
-        std::cout << std::endl;
+// Initializes the table from scratch: the tuple_num records of the key space,
+// each referring to its initial image, payload_size zero bytes in a second
+// array placed like the tuples
+void makeDB(const KeySpace& key_space, size_t tuple_num, size_t expected_num,
+            const ThreadPlacement& placement, size_t partition_num, size_t load_thread_num,
+            bool huge_pages) {
+    snapshot.release();
+    char* images = image_pages.allocate(tuple_num * payload_size, huge_pages);
+    buildTable(tuple_num, expected_num, placement, partition_num, load_thread_num, huge_pages,
+               !key_space.sparse(), [&key_space](uint64_t slot) { return key_space.id(slot); },
+               [images](uint64_t slot) {
+        char* image = images + slot * payload_size;
+        std::fill(image, image + payload_size, 0);
+        new (&Table[slot]) Tuple(image, static_cast<uint32_t>(payload_size));
+    });
+}
+
+// Initializes the table from a snapshot file: the file is mapped and the
+// tuples refer to their images in the mapping, so no image is read or copied
+// up front. Returns the snapshot's timestamp, where the next batch starts.
+uint64_t loadSnapshot(const std::string& path, const KeySpace& key_space, size_t tuple_num,
+                      size_t expected_num, const ThreadPlacement& placement, size_t partition_num,
+                      size_t load_thread_num, bool huge_pages) {
+    image_pages.release();
+    snapshot.open(path);
+    const SnapshotHeader& header = snapshot.header();
+    if (header.tuple_num_ != tuple_num || header.sparse_ != key_space.sparse() ||
+        header.payload_size_ != payload_size) {
+        throw std::invalid_argument("snapshot of " + std::to_string(header.tuple_num_) + " " +
+                                    (header.sparse_ ? "sparse" : "dense") + " keys with " +
+                                    std::to_string(header.payload_size_) +
+                                    " byte images; run it with matching --tuples, --keys and --payload");
     }
+    buildTable(header.record_num_, expected_num, placement, partition_num, load_thread_num, huge_pages,
+               false, [](uint64_t slot) { return snapshot.key(slot); },
+               [](uint64_t slot) {
+        new (&Table[slot]) Tuple(snapshot.image(slot), static_cast<uint32_t>(payload_size));
+    });
+    return header.timestamp_;
 }
 
-std::vector<Transaction> transactions;
-std::priority_queue<Transaction, std::vector<Transaction>, std::function<bool(const Transaction&, const Transaction&)>> ready_queue(
-    [](const Transaction& a, const Transaction& b) {
-        return a.timestamp_ > b.timestamp_; // Prioritize lower timestamps
+// Gives every partition its own version arena, where each version carries its
+// image, and its own arena for the records inserted into it. Only the CC
+// thread handling the partition in the current batch allocates from them.
+void initializeArenas(size_t partition_num) {
+    cc_arenas.clear();
+    cc_arenas.reserve(partition_num);
+    tuple_arenas.clear();
+    tuple_arenas.reserve(partition_num);
+    for (size_t i = 0; i < partition_num; ++i) {
+        cc_arenas.emplace_back(ARENA_SLAB_SIZE, Tuple::versionSize(payload_size));
+        tuple_arenas.emplace_back();
     }
-);
-std::mutex partition_mutex;
-std::condition_variable ready_queue_cv;
+}
 
-// Initializes the database table
-void makeDB(size_t tuple_num) {
-    posix_memalign((void**)&Table, PAGE_SIZE, tuple_num * sizeof(Tuple));
-    for (size_t i = 0; i < tuple_num; i++) {
-        Table[i] = Tuple();
+// Fills one request of the client stream; the sequencer assigns its timestamp.
+// Keys are drawn as ranks and mapped to record IDs; the sequence number of
+// the request makes the IDs of its inserts unique.
+void makeRequest(const WorkloadConfig& workload, const KeyGenerator& keys, const KeySpace& key_space,
+                 FastRandom& rng, uint64_t sequence, uint64_t arrival_ns, Request& request) {
+    WorkloadOp ops[MAX_OPE];
+    size_t task_num = generateOps(workload, keys, rng, ops);
+    request.arrival_ns_ = arrival_ns;
+    request.task_num_ = task_num;
+    for (size_t j = 0; j < task_num; ++j) {
+        const WorkloadOp& op = ops[j];
+        if (op.range) {
+            request.task_set_[j] = Task(Ope::SCAN, key_space.id(op.key), key_space.span(op.range));
+        } else if (op.insert) {
+            request.task_set_[j] = Task(Ope::INSERT, key_space.insertId(op.key, sequence * MAX_OPE + j));
+        } else {
+            request.task_set_[j] = Task(op.write ? Ope::WRITE : Ope::READ, key_space.id(op.key));
+        }
     }
 }
 
-// Initializes all transactions
-void initializeTransactions(size_t tuple_num) {
-    transactions.resize(tuple_num);
-    for (uint64_t i = 0; i < tuple_num; ++i) {
-        transactions[i] = Transaction(i);
-        transactions[i].task_set_ = {
-            Task(Ope::READ, i % tuple_num),
-            Task(Ope::WRITE, (i + 1) % tuple_num)
-        };
+// Queues the inputs of a sequenced batch for the command log; words is scratch space
+void logBatch(const Batch& batch, std::vector<uint64_t>& words) {
+    words.clear();
+    for (size_t t = 0; t < batch.size(); ++t) {
+        size_t descriptor = words.size();
+        words.push_back(logTransaction(batch.taskNum(t)));
+        for (size_t i = 0; i < batch.taskNum(t); ++i) {
+            logOperation(words[descriptor], i, static_cast<unsigned>(batch.ope(t, i)));
+            words.push_back(batch.key(t, i));
+            if (batch.ope(t, i) == Ope::SCAN) words.push_back(batch.range(t, i));
+        }
     }
+    command_log.append(batch.id(), batch.firstTimestamp(), batch.size(), words);
 }
 
-// CC phase worker function
-void cc_worker(int thread_id, const bool& start, const bool& quit) {
+// Sequencer: drains the client queue straight into the batches of the ring,
+// cut when batch_size transactions are in or batch_timeout_ns after the first
+// one arrived. Timestamps follow queue order; each batch is then published to
+// every CC thread and handed to the command log, whose writer releases it to
+// execution once durable.
+void sequencer(const bool& start, const bool& quit) {
     while (!__atomic_load_n(&start, __ATOMIC_SEQ_CST)) {}
 
-    while (!__atomic_load_n(&quit, __ATOMIC_SEQ_CST)) {
-        std::vector<Transaction> local_batch;
-
-        // Fetch a batch of transactions
-        uint64_t start_pos = __atomic_fetch_add(&tx_counter, BATCH_SIZE, __ATOMIC_SEQ_CST);
-        uint64_t end_pos = std::min(start_pos + BATCH_SIZE, (uint64_t)transactions.size());
-        for (uint64_t i = start_pos; i < end_pos; ++i) {
-            local_batch.emplace_back(transactions[i]);
+    uint64_t next_timestamp = first_timestamp;
+    Request request;
+    std::vector<uint64_t> log_words;
+    for (uint64_t batch_id = 0; ; ++batch_id) {
+        Batch* batch = batch_ring.acquire(batch_id, next_timestamp, quit);
+        if (!batch) return;
+        uint64_t deadline = UINT64_MAX;
+        while (!batch->full()) {
+            if (txn_source.pop(request)) {
+                if (batch->empty()) deadline = nowNanos() + batch_timeout_ns;
+                batch->append(request);
+                continue;
+            }
+            if (__atomic_load_n(&quit, __ATOMIC_SEQ_CST)) return;
+            if (txn_source.exhausted() || nowNanos() >= deadline) break;
+            std::this_thread::yield();
         }
+        if (batch->empty()) return; // input exhausted
 
-        // sort
-        std::sort(local_batch.begin(), local_batch.end(), [](const Transaction& a, const Transaction& b) {
-            return a.timestamp_ < b.timestamp_;
-        });
+        // every CC thread fills only the version slots of the tasks it owns
+        next_timestamp += batch->size();
+        batch_ring.sequence(batch_id, split.ccThreads(batch_id, batch_ring));
+        if (command_log.isOpen()) logBatch(*batch, log_words);
+        else batch_ring.persist(batch_id + 1);
+        __atomic_store_n(&tx_counter, next_timestamp, __ATOMIC_RELEASE);
+    }
+}
 
-        // Process each transaction in the CC phase
-        for (auto& trans : local_batch) {
-            for (const auto& task : trans.task_set_) {
-                if (task.ope_ == Ope::WRITE &&
-                    std::find(thread_partitions[thread_id].begin(),
-                              thread_partitions[thread_id].end(),
-                              task.key_) != thread_partitions[thread_id].end()) {
-                    Table[task.key_].addPlaceholder(trans.timestamp_);
-                    trans.write_set_.emplace_back(task.key_);
-                }
-            }
+// Decodes the logged transaction at words[word] into request and moves word
+// past it; false if the words do not hold a well-formed transaction
+bool readLoggedRequest(const std::vector<uint64_t>& words, size_t& word, Request& request) {
+    if (word >= words.size()) return false;
+    uint64_t descriptor = words[word++];
+    request.task_num_ = loggedTaskNum(descriptor);
+    if (request.task_num_ == 0 || request.task_num_ > MAX_OPE) return false;
+    for (uint32_t j = 0; j < request.task_num_; ++j) {
+        unsigned operation = loggedOperation(descriptor, j);
+        size_t width = operation == static_cast<unsigned>(Ope::SCAN) ? 2 : 1;
+        if (operation > static_cast<unsigned>(Ope::INSERT) || word + width > words.size()) return false;
+        uint64_t key = words[word++];
+        uint64_t range = width == 2 ? words[word++] : 0;
+        request.task_set_[j] = Task(static_cast<Ope>(operation), key, range);
+    }
+    return true;
+}
 
-            // Push the transaction to the ready queue
-            {
-                std::lock_guard<std::mutex> lock(partition_mutex);
-                ready_queue.push(trans);
+// Checks a command log against this run before replaying it; returns the
+// number of logged transactions and widens batch_capacity to the largest batch.
+// Any key is valid: one that was never inserted names no record.
+uint64_t checkReplay(const std::vector<LoggedBatch>& log, size_t& batch_capacity) {
+    uint64_t txn_num = 0;
+    Request request;
+    for (const LoggedBatch& batch : log) {
+        size_t word = 0;
+        for (uint32_t t = 0; t < batch.txn_num_; ++t) {
+            if (!readLoggedRequest(batch.words_, word, request)) {
+                throw std::invalid_argument("malformed transaction in logged batch " +
+                                            std::to_string(batch.batch_id_));
             }
         }
-        ready_queue_cv.notify_all(); // Notify Execution Workers
+        batch_capacity = std::max<size_t>(batch_capacity, batch.txn_num_);
+        txn_num += batch.txn_num_;
+    }
+    return txn_num;
+}
+
+// Drops the logged batches a snapshot already contains, the ones before its
+// timestamp; the rest must start right at it and are renumbered from 0
+void skipSnapshotted(std::vector<LoggedBatch>& log, uint64_t timestamp) {
+    auto first = std::find_if(log.begin(), log.end(), [timestamp](const LoggedBatch& batch) {
+        return batch.first_timestamp_ >= timestamp;
+    });
+    log.erase(log.begin(), first);
+    if (!log.empty() && log.front().first_timestamp_ != timestamp) {
+        throw std::invalid_argument("the command log does not continue the snapshot at timestamp " +
+                                    std::to_string(timestamp));
     }
+    for (size_t i = 0; i < log.size(); ++i) log[i].batch_id_ = i;
 }
 
-void execution_worker(int thread_id, const bool& start, const bool& quit) {
+// Recovery: sequences the batches of a command log again with their logged
+// ids and timestamps. Execution is deterministic given that order, so the CC
+// and execution phases rebuild the state the logged run reached.
+void replaySequencer(const std::vector<LoggedBatch>& log, const bool& start, const bool& quit) {
     while (!__atomic_load_n(&start, __ATOMIC_SEQ_CST)) {}
 
-    while (!__atomic_load_n(&quit, __ATOMIC_SEQ_CST)) {
-        std::vector<Transaction> local_batch;
+    Request request;
+    for (const LoggedBatch& logged : log) {
+        Batch* batch = batch_ring.acquire(logged.batch_id_, logged.first_timestamp_, quit);
+        if (!batch) return;
+        request.arrival_ns_ = nowNanos();
+        size_t word = 0;
+        for (uint32_t t = 0; t < logged.txn_num_; ++t) {
+            readLoggedRequest(logged.words_, word, request); // checked by checkReplay
+            batch->append(request);
+        }
+        batch_ring.sequence(logged.batch_id_, split.ccThreads(logged.batch_id_, batch_ring));
+        batch_ring.persist(logged.batch_id_ + 1);
+        __atomic_store_n(&tx_counter, logged.first_timestamp_ + logged.txn_num_, __ATOMIC_RELEASE);
+    }
+}
+
+// Last key of a scan's range, which may not wrap around the key space; false
+// for an empty range
+bool scanLast(uint64_t low, uint64_t range, uint64_t& last) {
+    if (range == 0) return false;
+    last = low + (range - 1) < low ? UINT64_MAX : low + (range - 1);
+    return true;
+}
+
+// CC phase of a scan on partition p: the records of the range in the
+// partition, each with the version the scan reads. Batches are processed in
+// timestamp order, so the index holds exactly the records that exist at the
+// scan's timestamp; a record entered later can never show up in the scan as
+// a phantom, whichever order the transactions execute in. Versions are
+// looked up once the leaves have been walked, with the tuples already on
+// their way into the cache. Each record is pinned to the exact version the
+// scan sees, committed ones too, so the execution phase reads it directly
+// however many versions later batches have added in front of it.
+void resolveScan(size_t p, Batch& batch, size_t t, size_t i) {
+    std::vector<ScanEntry>& entries = batch.scanEntries(p);
+    size_t begin = entries.size();
+    uint64_t low = batch.key(t, i);
+    uint64_t last = 0;
+    if (scanLast(low, batch.range(t, i), last)) {
+        indexes[p].scan(low, last, [&entries](uint64_t key, Tuple* tuple) {
+            __builtin_prefetch(tuple);
+            entries.push_back({key, tuple, nullptr, nullptr});
+        });
+    }
+    for (size_t e = begin; e < entries.size(); ++e) {
+        entries[e].version_ = entries[e].tuple_->newestVersion();
+    }
+    batch.endScan(p);
+}
+
+// CC phase of an insert of a key not in the table: a record that did not
+// exist before the insert, with the insert's placeholder. The record reads as
+// absent, a null image, at earlier timestamps; it is published only once the
+// placeholder is in, so whoever finds it also finds the insert.
+Tuple::Version* insertRecord(int thread_id, size_t p, uint64_t key, uint64_t timestamp) {
+    Tuple* tuple = tuple_arenas[p].allocate(nullptr, static_cast<uint32_t>(payload_size));
+    Tuple::Version* version = tuple->addPlaceholder(timestamp, cc_arenas[p]);
+    primary.insert(key, tuple);
+    indexes[p].insert(key, tuple);
+    AllResult[thread_id].insert_cnt_++;
+    return version;
+}
+
+// CC phase of a batch on one of its CC threads: sees every transaction and
+// installs placeholders only for the records of the partitions the thread
+// handles in this batch, every cc_threads-th one from its own
+void runCCPhase(int thread_id, Batch& batch) {
+    uint64_t batch_start = nowNanos();
+    size_t cc_threads = batch.ccThreads();
 
-        {
-            std::unique_lock<std::mutex> lock(partition_mutex);
-            while (ready_queue.empty() && !quit) {
-                ready_queue_cv.wait(lock);
+    // recycle versions no live reader can reach, then keep this batch's
+    // versions contiguous in each partition's arena
+    uint64_t low_watermark = batch_ring.lowWatermark();
+    low_watermark = std::min(low_watermark, snapshots.oldest());
+    for (size_t p = thread_id; p < partition_count; p += cc_threads) {
+        cc_arenas[p].reclaim(low_watermark);
+        cc_arenas[p].reserve(batch.size() * MAX_OPE);
+        batch.beginScans(p);
+    }
+
+    // Process each transaction in the CC phase
+    for (size_t t = 0; t < batch.size(); ++t) {
+        for (size_t i = 0; i < batch.taskNum(t); ++i) {
+            if (batch.ope(t, i) == Ope::SCAN) {
+                for (size_t p = thread_id; p < partition_count; p += cc_threads) resolveScan(p, batch, t, i);
+                continue;
             }
-            // Retrieve the transaction with the lowest timestamp from the priority queue
-            while (!ready_queue.empty()) {
-                local_batch.push_back(ready_queue.top());
-                ready_queue.pop();
+            uint64_t key = batch.key(t, i);
+            size_t p = partitioner.owner(key);
+            if (p % cc_threads != static_cast<size_t>(thread_id)) continue;
+            Tuple* tuple = findRecord(key);
+            if (batch.ope(t, i) == Ope::INSERT && !tuple) {
+                batch.version(t, i) = insertRecord(thread_id, p, key, batch.timestamp(t));
+                AllResult[thread_id].placeholder_cnt_++;
+            } else if (!tuple) {
+                // a read of a missing record finds nothing and a write of
+                // one does nothing; the execution phase sees no version
+                batch.version(t, i) = nullptr;
+            } else if (batch.ope(t, i) != Ope::READ) {
+                collectGarbage(p, *tuple, low_watermark);
+                batch.version(t, i) = tuple->addPlaceholder(batch.timestamp(t), cc_arenas[p]);
+                AllResult[thread_id].placeholder_cnt_++;
+            } else {
+                // batches are processed in timestamp order, so the newest
+                // version right now is exactly the one this read must see;
+                // nullptr if that is the committed version inline in the tuple
+                batch.version(t, i) = tuple->pendingVersion();
             }
         }
+    }
+
+    // End of the CC phase for this batch
+    uint64_t cc_ns = nowNanos() - batch_start;
+    AllResult[thread_id].cc_phase_.record(cc_ns);
+    split.addCC(thread_id, cc_ns);
+    batch_ring.finishCC(batch.id());
+}
+
+// Work-stealing scheduler of the execution phase: one deque per worker, as
+// any worker may execute
+std::vector<WorkStealingDeque<Transaction>> exec_deques;
+
+void initializeScheduler(size_t worker_num) {
+    exec_deques.clear();
+    exec_deques.reserve(worker_num);
+    for (size_t i = 0; i < worker_num; ++i) {
+        // a deque never holds more than the transactions in flight
+        exec_deques.emplace_back(RING_SIZE * batch_size);
+    }
+}
+
+// Next runnable transaction: requeued work first, then the oldest unclaimed
+// transaction of a released batch, then work stolen from another thread
+Transaction* nextTransaction(size_t thread_id) {
+    if (Transaction* trans = exec_deques[thread_id].pop()) return trans;
+    if (Transaction* trans = batch_ring.tryClaim()) return trans;
+    for (size_t i = 1; i < exec_deques.size(); ++i) {
+        if (Transaction* trans = exec_deques[(thread_id + i) % exec_deques.size()].steal()) return trans;
+    }
+    return nullptr;
+}
+
+// A write builds its new image in place in the placeholder: every word holds
+// the writer's timestamp, so a reader can tell which version it saw
+void buildImage(std::span<char> image, uint64_t timestamp) {
+    for (size_t offset = 0; offset + sizeof(timestamp) <= image.size(); offset += sizeof(timestamp)) {
+        std::memcpy(image.data() + offset, &timestamp, sizeof(timestamp));
+    }
+}
+
+uint64_t firstWord(Payload image) {
+    uint64_t word = 0;
+    std::memcpy(&word, image.data(), std::min(image.size(), sizeof(word)));
+    return word;
+}
+
+// Reads look at every byte of the view they get, as a query would
+uint64_t digestImage(Payload image) {
+    uint64_t digest = 0;
+    for (size_t offset = 0; offset + sizeof(digest) <= image.size(); offset += sizeof(digest)) {
+        uint64_t word;
+        std::memcpy(&word, image.data() + offset, sizeof(word));
+        digest = digest * 31 + word;
+    }
+    return digest;
+}
+
+// Image of the version a read resolved in the CC phase. A read resolved to
+// the inline version rechecks it, a writer of a later batch may have replaced
+// it; the pending version is kept for resumption. nullopt if the transaction
+// was deferred on it instead, after which the caller must leave it alone.
+std::optional<Payload> readVersion(int thread_id, Transaction& trans, Tuple& tuple,
+                                   Tuple::Version*& version, uint64_t& run_start) {
+    std::optional<Payload> image;
+    if (!version) image = tuple.read(trans.batch_->timestamp(trans.index_), version);
+    if (!image.has_value()) image = tuple.spinResolved(version);
+    if (!image.has_value()) {
+        trans.exec_ns_ += nowNanos() - run_start;
+        if (Tuple::addWaiter(version, &trans)) {
+            AllResult[thread_id].retry_cnt_++;
+            return std::nullopt;
+        }
+        run_start = nowNanos();
+        image = tuple.readResolved(version);
+    }
+    return image;
+}
+
+// Runs a transaction from its resume point. Returns false if it was deferred
+// on an unfilled version; the writer of that version requeues it. scan_parts
+// is scratch space for merging the records of a scan.
+bool executeTransaction(int thread_id, Transaction& trans,
+                        std::vector<std::span<const ScanEntry>>& scan_parts) {
+    Batch& batch = *trans.batch_;
+    size_t t = trans.index_;
+    uint64_t run_start = nowNanos();
+    if (trans.status_ == Status::UNPROCESSED) {
+        AllResult[thread_id].queue_wait_.record(run_start - batch_ring.releasedAt(batch.id()));
+        trans.startExecution();
+#ifdef BOHM_DEBUG
+        std::cout << "[DEBUG] Thread " << thread_id << ": Executing transaction " 
+                  << batch.timestamp(t) << std::endl;
+#endif
+    }
 
-        for (auto& trans : local_batch) {
-            if (trans.status_ == Status::UNPROCESSED) {
-                trans.startExecution();
-                std::cout << "[DEBUG] Thread " << thread_id << ": Executing transaction " 
-                          << trans.timestamp_ << std::endl;
-
-                bool success = true;
-                int retry_count = 0;
-
-                do {
-                    success = true;
-                    for (const auto& task : trans.task_set_) {
-                        switch (task.ope_) {
-                        case Ope::READ: {
-                            auto value = Table[task.key_].getVersion(trans.timestamp_);
-                            if (!value.has_value()) {
-                                success = false;
-                                retry_count++;
-                                std::cerr << "[DEBUG] Thread " << thread_id 
-                                          << ": Missing version for key " << task.key_ 
-                                          << " in transaction " << trans.timestamp_ 
-                                          << ", retry count: " << retry_count << std::endl;
-                                std::this_thread::sleep_for(std::chrono::microseconds(10));
-                            } else {
-                                std::cout << "[DEBUG] Thread " << thread_id 
-                                          << ": READ value " << value.value() 
-                                          << " for key " << task.key_ 
-                                          << " in transaction " << trans.timestamp_ << std::endl;
-                            }
-                            break;
-                        }
-                        case Ope::WRITE: {
-                            Table[task.key_].updatePlaceholder(trans.timestamp_, 100);
-                            std::cout << "[DEBUG] Thread " << thread_id 
-                                      << ": Updated WRITE placeholder for key " << task.key_ 
-                                      << " in transaction " << trans.timestamp_ << std::endl;
-                            break;
-                        }
-                        default:
-                            std::cerr << "[ERROR] Thread " << thread_id 
-                                      << ": Unknown operation type in transaction " 
-                                      << trans.timestamp_ << std::endl;
-                            success = false; 
-                        }
-                        if (!success) break;
+    for (; trans.resume_task_ < batch.taskNum(t); ++trans.resume_task_) {
+        size_t i = trans.resume_task_;
+        Tuple::Version*& version = batch.version(t, i);
+        switch (batch.ope(t, i)) {
+        case Ope::READ: {
+            // a record inserted after the CC phase ran is not visible, and
+            // one not inserted yet at the read's timestamp has no image
+            Tuple* tuple = findRecord(batch.key(t, i));
+            if (!tuple) break;
+            std::optional<Payload> image = readVersion(thread_id, trans, *tuple, version, run_start);
+            if (!image.has_value()) return false;
+            if (!image->data()) break;
+            trans.digest_ += digestImage(*image);
+#ifdef BOHM_DEBUG
+            std::cout << "[DEBUG] Thread " << thread_id 
+                      << ": READ value " << firstWord(*image) 
+                      << " for key " << batch.key(t, i) 
+                      << " in transaction " << batch.timestamp(t) << std::endl;
+#endif
+            break;
+        }
+        case Ope::WRITE:
+        case Ope::INSERT: {
+            if (!version) break; // a write of a missing record
+            Tuple& tuple = *findRecord(batch.key(t, i));
+            buildImage(tuple.image(version), batch.timestamp(t));
+            VersionWaiter* waiter = tuple.fillPlaceholder(version);
+            while (waiter) {
+                VersionWaiter* next = waiter->next_waiter_;
+                exec_deques[thread_id].push(static_cast<Transaction*>(waiter));
+                waiter = next;
+            }
+#ifdef BOHM_DEBUG
+            std::cout << "[DEBUG] Thread " << thread_id 
+                      << ": Updated " << (batch.ope(t, i) == Ope::WRITE ? "WRITE" : "INSERT")
+                      << " placeholder for key " << batch.key(t, i) 
+                      << " in transaction " << batch.timestamp(t) << std::endl;
+#endif
+            break;
+        }
+        case Ope::SCAN: {
+            // all records are read before any is used, the lookups of each
+            // part issued together; a deferred scan resumes at the first
+            // record it has not read, so each record is looked up once
+            // however often the scan waits
+            size_t skip = trans.scan_read_;
+            for (size_t c = 0; c < partition_count; ++c) {
+                std::span<ScanEntry> part = batch.scanPart(c, t, i);
+                std::span<ScanEntry> unread = part.subspan(std::min(skip, part.size()));
+                skip -= part.size() - unread.size();
+                for (const ScanEntry& entry : unread) {
+                    // a pinned version is read without touching the tuple
+                    if (entry.version_) {
+                        __builtin_prefetch(entry.version_);
+                    } else {
+                        __builtin_prefetch(entry.tuple_);
                     }
-                } while (!success && retry_count < MAX_RETRY);
-
-                if (success) {
-                    trans.commit();
-                    AllResult[thread_id].commit_cnt_++;
-                    std::cout << "[DEBUG] Thread " << thread_id 
-                              << ": Transaction " << trans.timestamp_ 
-                              << " committed successfully after " 
-                              << retry_count << " retries" << std::endl;
-                } else {
-                    std::cerr << "[ERROR] Thread " << thread_id 
-                              << ": Transaction " << trans.timestamp_ 
-                              << " failed after max retries (" 
-                              << retry_count << ")" << std::endl;
                 }
             }
+            skip = trans.scan_read_;
+            for (size_t c = 0; c < partition_count; ++c) {
+                std::span<ScanEntry> part = batch.scanPart(c, t, i);
+                std::span<ScanEntry> unread = part.subspan(std::min(skip, part.size()));
+                skip -= part.size() - unread.size();
+                for (ScanEntry& entry : unread) {
+                    std::optional<Payload> image =
+                        readVersion(thread_id, trans, *entry.tuple_, entry.version_, run_start);
+                    if (!image.has_value()) return false;
+                    entry.image_ = image->data();
+                    ++trans.scan_read_;
+                }
+            }
+            size_t record_num = trans.scan_read_;
+            trans.scan_read_ = 0;
+            scan_parts.clear();
+            for (size_t c = 0; c < partition_count; ++c) scan_parts.push_back(batch.scanPart(c, t, i));
+            uint64_t digest = 0;
+            visitInKeyOrder(scan_parts, [&digest](const ScanEntry& entry) {
+                digest = digest * 31 + digestImage(Payload(entry.image_, entry.tuple_->payloadSize()));
+            });
+            trans.digest_ += digest;
+            AllResult[thread_id].scan_cnt_++;
+            AllResult[thread_id].scanned_cnt_ += record_num;
+#ifdef BOHM_DEBUG
+            std::cout << "[DEBUG] Thread " << thread_id
+                      << ": SCAN " << record_num << " records from key " << batch.key(t, i)
+                      << " in transaction " << batch.timestamp(t) << std::endl;
+#endif
+            break;
+        }
+        default:
+            std::cerr << "[ERROR] Thread " << thread_id 
+                      << ": Unknown operation type in transaction " 
+                      << batch.timestamp(t) << std::endl;
+        }
+    }
+    trans.exec_ns_ += nowNanos() - run_start;
+    return true;
+}
+
+// Runs the next runnable transaction, committing it unless it was deferred;
+// false if there was none
+bool executeNext(int thread_id, std::vector<std::span<const ScanEntry>>& scan_parts) {
+    Transaction* trans = nextTransaction(thread_id);
+    if (!trans) return false;
+    if (!executeTransaction(thread_id, *trans, scan_parts)) return true;
+
+    // the slot may be refilled once the batch completes
+    const Batch& batch = *trans->batch_;
+    trans->commit();
+    AllResult[thread_id].commit_cnt_++;
+    AllResult[thread_id].execution_.record(trans->exec_ns_);
+    AllResult[thread_id].end_to_end_.record(nowNanos() - batch.arrival(trans->index_));
+    split.addExecution(thread_id, trans->exec_ns_);
+#ifdef BOHM_DEBUG
+    std::cout << "[DEBUG] Thread " << thread_id 
+              << ": Transaction " << batch.timestamp(trans->index_) 
+              << " committed successfully" << std::endl;
+#endif
+    batch_ring.complete(batch.id());
+    return true;
+}
+
+// Worker function: runs the CC phase of every batch whose split makes it a
+// CC thread, in batch order, and executes transactions otherwise. A worker
+// follows the batches as they are sequenced, so it takes up the role each
+// batch gives it; the CC phase of a batch split differently from the one
+// before waits until that one's is done, since the partitions changed hands.
+void worker(int thread_id, const bool& start, const bool& quit) {
+    std::vector<std::span<const ScanEntry>> scan_parts;
+    size_t cc_threads = 0; // of the last batch seen; nothing runs before the first
+    while (!__atomic_load_n(&start, __ATOMIC_SEQ_CST)) {}
+
+    uint64_t batch_id = 0;
+    while (!__atomic_load_n(&quit, __ATOMIC_SEQ_CST)) {
+        size_t batch_cc_threads = 0;
+        if (Batch* batch = batch_ring.sequenced(batch_id, batch_cc_threads)) {
+            // a recycled slot was left behind by the other CC threads
+            if (batch_cc_threads) cc_threads = batch_cc_threads;
+            if (static_cast<size_t>(thread_id) < batch_cc_threads) {
+                if (batch->repartitioned() && batch_id > 0 && !batch_ring.ccFinished(batch_id - 1)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                runCCPhase(thread_id, *batch);
+            }
+            ++batch_id;
+            continue;
+        }
+        if (static_cast<size_t>(thread_id) < cc_threads || !executeNext(thread_id, scan_parts)) {
+            std::this_thread::yield();
         }
     }
 }
 
+// Read-only transactions run on their own threads against the state just
+// before the low watermark, the newest one fully executed. They never go
+// through the sequencer, the CC threads or the ring, so they scale with their
+// threads whatever the pipeline does. A scan walks the partitions' indexes
+// itself, beside the CC threads entering records into them.
+uint64_t read_only_digest = 0; // keeps the reads from being optimized away
 
-int main(int argc, char* argv[]) {
-    size_t thread_num = DEFAULT_THREAD_NUM;
-    size_t tuple_num = DEFAULT_TUPLE_NUM;
+// Records a scan finds may have been inserted after its snapshot; they have
+// no image at its timestamp and are skipped
+uint64_t snapshotScan(Result& result, uint64_t low, uint64_t range, uint64_t timestamp,
+                      std::vector<std::vector<ScanEntry>>& entries,
+                      std::vector<std::span<const ScanEntry>>& parts) {
+    parts.clear();
+    uint64_t last = 0;
+    bool any = scanLast(low, range, last);
+    for (size_t c = 0; c < entries.size(); ++c) {
+        entries[c].clear();
+        if (any) {
+            indexes[c].scan(low, last, [&entries, c](uint64_t key, Tuple* tuple) {
+                __builtin_prefetch(tuple);
+                entries[c].push_back({key, tuple, nullptr, nullptr});
+            });
+        }
+        parts.push_back(entries[c]);
+    }
+    result.scan_cnt_++;
+    uint64_t digest = 0;
+    visitInKeyOrder(parts, [&result, &digest, timestamp](const ScanEntry& entry) {
+        Payload image = *entry.tuple_->getVersion(timestamp - 1);
+        if (!image.data()) return;
+        digest = digest * 31 + digestImage(image);
+        result.scanned_cnt_++;
+    });
+    return digest;
+}
 
-    if (argc > 1) thread_num = std::stoul(argv[1]);
-    if (argc > 2) tuple_num = std::stoul(argv[2]);
+void reader_worker(int thread_id, size_t slot, const WorkloadConfig& workload,
+                   const KeyGenerator& keys, const KeySpace& key_space,
+                   const bool& start, const bool& quit) {
+    FastRandom rng(workload.seed ^ (0xd1b54a32d192ed03ULL * (slot + 1)));
+    WorkloadOp ops[MAX_OPE];
+    uint64_t digest = 0;
+    std::vector<std::vector<ScanEntry>> scan_entries(partition_count);
+    std::vector<std::span<const ScanEntry>> scan_parts;
+    while (!__atomic_load_n(&start, __ATOMIC_SEQ_CST)) {}
 
-    AllResult.resize(thread_num);
+    while (!__atomic_load_n(&quit, __ATOMIC_ACQUIRE)) {
+        size_t task_num = generateOps(workload, keys, rng, ops);
+        uint64_t start_ns = nowNanos();
+        uint64_t timestamp = snapshots.enter(slot);
+        for (size_t i = 0; i < task_num; ++i) {
+            if (ops[i].range) {
+                digest += snapshotScan(AllResult[thread_id], key_space.id(ops[i].key),
+                                       key_space.span(ops[i].range), timestamp, scan_entries, scan_parts);
+                continue;
+            }
+            Tuple* tuple = findRecord(key_space.id(ops[i].key));
+            if (!tuple) continue;
+            Payload image = *tuple->getVersion(timestamp - 1);
+            if (image.data()) digest += digestImage(image);
+        }
+        snapshots.exit(slot);
+        AllResult[thread_id].read_only_.record(nowNanos() - start_ns);
+        AllResult[thread_id].read_only_cnt_++;
+    }
+    __atomic_fetch_add(&read_only_digest, digest, __ATOMIC_RELAXED);
+}
 
-    size_t cc_thread_num = thread_num / 2;
-    size_t exec_thread_num = thread_num - cc_thread_num;
+// Background checkpointer: every interval_ns writes the state just before the
+// low watermark to path, replacing the previous checkpoint. It reads like a
+// read-only transaction, so the workers never wait for it. Records are
+// written in partition and key order, those not inserted yet at its
+// timestamp left out: a first pass counts them for the header, then their
+// keys and images are streamed from the indexes into the file.
+void checkpointer(const std::string& path, uint64_t interval_ns, size_t slot, const KeySpace& key_space,
+                  size_t tuple_num, const bool& quit) {
+    uint64_t next_ns = nowNanos() + interval_ns;
+    while (!__atomic_load_n(&quit, __ATOMIC_ACQUIRE)) {
+        if (nowNanos() < next_ns) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        uint64_t start_ns = nowNanos();
+        uint64_t timestamp = snapshots.enter(slot);
+        // the records as of the checkpoint; the same ones in the same order
+        // on every pass, as records are never removed
+        auto records = [timestamp](auto emit) {
+            forEachRecord([&emit, timestamp](uint64_t key, Tuple* tuple) {
+                Payload image = *tuple->getVersion(timestamp - 1);
+                if (image.data()) emit(key, image);
+            });
+        };
+        uint64_t record_num = 0;
+        records([&record_num](uint64_t, Payload) { record_num++; });
+        SnapshotHeader header{SnapshotHeader::MAGIC, timestamp, record_num, payload_size,
+                              tuple_num, key_space.sparse()};
+        bool written = false;
+        try {
+            written = writeSnapshot(path, header, records,
+                                    [&quit] { return __atomic_load_n(&quit, __ATOMIC_ACQUIRE); });
+        } catch (const std::exception& error) {
+            std::cerr << "[ERROR] checkpoint: " << error.what() << std::endl;
+        }
+        snapshots.exit(slot);
+        if (written) {
+            std::cout << "[CHECKPOINT] timestamp " << timestamp << ", "
+                      << record_num * payload_size / 1e6 << " MB in "
+                      << (nowNanos() - start_ns) / 1e6 << " ms" << std::endl;
+        }
+        next_ns = nowNanos() + interval_ns;
+    }
+}
 
-    makeDB(tuple_num);
-    initializeTransactions(tuple_num);
-    assignRecordsToCCThreads(cc_thread_num, tuple_num);
+// Digest of every record's key and newest image, to compare a replayed run
+// with the logged one; only meaningful once the pipeline has drained. The
+// partitions may differ between the runs, so record order does not count.
+// A run stopped by its duration leaves placeholders unfilled; their records
+// are left out.
+uint64_t tableDigest() {
+    uint64_t digest = 0;
+    forEachRecord([&digest](uint64_t key, Tuple* tuple) {
+        std::optional<Payload> image = tuple->getVersion(UINT64_MAX);
+        if (image && image->data()) digest += (digestImage(*image) ^ key) * 0x100000001b3ULL;
+    });
+    return digest;
+}
 
-    // Debug record distribution
-    debugRecordDistribution(cc_thread_num);
+} // namespace pipeline
+
+// Runs the pipeline until every transaction has committed or the duration
+// expires. The workers are split between the CC phase and execution: fixed
+// at --cc-threads (half of them by default), or with --cc-threads auto
+// re-decided every SPLIT_INTERVAL (8) batches by the SplitController.
+// Transactions come from the clients, or from a command log when replaying.
+// Read-only transactions run on reader_num further threads, beside the pipeline.
+RunReport runBohm(const BenchConfig& config) {
+    using namespace pipeline;
+    if (config.thread_num < 2) {
+        throw std::invalid_argument("bohm needs at least 2 threads (CC and execution)");
+    }
+
+    KeySpace key_space(config.tuple_num, config.sparse_keys);
+    if (key_space.sparse() && config.strategy == PartitionStrategy::TABLE) {
+        throw std::invalid_argument("the table partition needs dense keys");
+    }
+
+    size_t thread_num = config.thread_num;
+    size_t tuple_num = config.tuple_num;
+    size_t cc_thread_num = config.cc_thread_num ? config.cc_thread_num : thread_num / 2;
+    if (cc_thread_num >= thread_num) {
+        throw std::invalid_argument("bohm needs fewer CC threads than threads, to leave one executing");
+    }
+    // an adaptive split may give any worker but one a partition of its own
+    size_t partition_num = config.adaptive_split ? thread_num - 1 : cc_thread_num;
+    size_t reader_num = config.reader_num;
+    partition_count = partition_num;
+    batch_size = config.batch_size;
+    payload_size = config.payload_size;
+    tx_counter = 0;
+    AllResult.assign(thread_num + reader_num, Result());
+
+    batch_timeout_ns = config.batch_timeout_us * 1000;
+    ThreadPlacement placement;
+    if (config.numa) {
+        // workers of an adaptive split change roles, so they are placed as one group
+        placement = config.adaptive_split
+            ? ThreadPlacement(NumaTopology(), {thread_num, reader_num})
+            : ThreadPlacement(NumaTopology(), {cc_thread_num, thread_num - cc_thread_num, reader_num});
+    }
+    uint64_t load_start = nowNanos();
+    assignRecordsToCCThreads(partition_num, key_space.bound(), config.strategy);
+    initializeArenas(partition_num);
+    // the primary index starts out large enough for the inserts a bounded run makes
+    size_t expected_num = tuple_num;
+    if (config.workload.insert_ratio > 0) {
+        expected_num += static_cast<size_t>(config.source.limit * config.workload.max_ops *
+                                            config.workload.insert_ratio);
+    }
+    first_timestamp = 1;
+    size_t record_num = tuple_num;
+    bool from_snapshot = !config.snapshot_path.empty();
+    if (!from_snapshot) {
+        makeDB(key_space, tuple_num, expected_num, placement, partition_num, thread_num,
+               config.huge_pages);
+    } else {
+        first_timestamp = loadSnapshot(config.snapshot_path, key_space, tuple_num, expected_num,
+                                       placement, partition_num, thread_num, config.huge_pages);
+        record_num = snapshot.header().record_num_;
+    }
+    double load_sec = (nowNanos() - load_start) / 1e9;
+    std::cout << "[LOAD] " << record_num << " tuples" << (from_snapshot ? " mapped" : " built")
+              << " on " << (placement.pinned() ? partition_num : thread_num) << " threads in "
+              << load_sec * 1000 << " ms";
+    if (from_snapshot) std::cout << ", starting at timestamp " << first_timestamp;
+    std::cout << std::endl;
+    if (placement.pinned()) {
+        auto owner = [&key_space, from_snapshot](uint64_t slot) {
+            return partitioner.owner(from_snapshot ? snapshot.key(slot) : key_space.id(slot));
+        };
+        printPlacement(std::cout, "tuples", samplePlacement(record_num, placement, 4096, owner,
+                       [](uint64_t slot) -> const void* { return &Table[slot]; }));
+    }
+
+    // a replay continues from the snapshot, if any
+    bool replaying = !config.replay_path.empty();
+    std::vector<LoggedBatch> replay_log;
+    uint64_t limit = config.source.limit;
+    size_t batch_capacity = batch_size;
+    if (replaying) {
+        replay_log = readCommandLog(config.replay_path);
+        skipSnapshotted(replay_log, first_timestamp);
+        limit = checkReplay(replay_log, batch_capacity);
+    }
+
+    batch_ring.init(partition_num, cc_thread_num, batch_capacity, first_timestamp);
+    split.init(thread_num, cc_thread_num, config.adaptive_split);
+    snapshots.init(reader_num + 1); // the last slot is the checkpointer's
+    initializeScheduler(thread_num);
+    if (config.log_sync != LogSync::OFF) {
+        command_log.open(config.log_path, config.log_sync, config.log_window_us,
+                         [](uint64_t batch_count) { batch_ring.persist(batch_count); });
+    }
+
+#ifdef BOHM_DEBUG
+    debugRecordDistribution(partition_num);
+#endif
 
     bool start = false;
+    bool stop_input = false; // ends the sequencer; the workers run on until quit
     bool quit = false;
 
-    std::vector<std::thread> cc_workers, execution_workers;
+    std::vector<std::thread> workers, readers;
 
-    // Launch CC workers
-    for (size_t i = 0; i < cc_thread_num; ++i) {
-        cc_workers.emplace_back(cc_worker, i, std::ref(start), std::ref(quit));
+    // Launch the sequencer, and the checkpointer if asked for
+    std::thread checkpoint_thread;
+    if (!config.checkpoint_path.empty()) {
+        checkpoint_thread = std::thread(checkpointer, std::cref(config.checkpoint_path),
+                                        config.checkpoint_interval_ms * 1000000, reader_num,
+                                        std::cref(key_space), tuple_num, std::cref(quit));
     }
+    std::thread sequencer_thread = replaying
+        ? std::thread(replaySequencer, std::cref(replay_log), std::cref(start), std::cref(stop_input))
+        : std::thread(sequencer, std::cref(start), std::cref(stop_input));
 
-    // Launch Execution workers
-    for (size_t i = 0; i < exec_thread_num; ++i) {
-        execution_workers.emplace_back(execution_worker, i + cc_thread_num, std::ref(start), std::ref(quit));
+    // Launch the workers, the first cc_thread_num starting out as CC threads,
+    // each pinned in NUMA mode
+    for (size_t i = 0; i < thread_num; ++i) {
+        workers.emplace_back([&, i] {
+            placement.pin(i);
+            worker(i, start, quit);
+        });
     }
 
+    // Readers draw their keys like the clients, but only read
+    KeyGenerator keys(config.workload, tuple_num, thread_num);
+    const WorkloadConfig& workload = config.workload;
+    WorkloadConfig read_only = workload;
+    read_only.read_ratio = 1.0;
+    read_only.rmw_ratio = 0.0;
+    read_only.insert_ratio = 0.0;
+    for (size_t i = 0; i < reader_num; ++i) {
+        readers.emplace_back([&, i] {
+            placement.pin(thread_num + i);
+            reader_worker(thread_num + i, i, read_only, keys, key_space, start, quit);
+        });
+    }
+
+    // Start the clients, then release the workers; the clients run on their own schedule
+    uint64_t start_ns = nowNanos();
+    if (!replaying) {
+        txn_source.start(config.source, workload.seed, start_ns,
+                         [&](FastRandom& rng, uint64_t sequence, uint64_t arrival_ns, Request& request) {
+                             makeRequest(workload, keys, key_space, rng, sequence, arrival_ns, request);
+                         });
+    }
     __atomic_store_n(&start, true, __ATOMIC_SEQ_CST);
-    std::this_thread::sleep_for(std::chrono::seconds(EX_TIME));
-    __atomic_store_n(&quit, true, __ATOMIC_SEQ_CST);
 
-    for (auto& worker : cc_workers) worker.join();
-    for (auto& worker : execution_workers) worker.join();
+    // a replay runs to the end of its log, an empty one included, whatever the
+    // duration; a failed log ends the run, as nothing becomes durable after it
+    double elapsed = 0.0;
+    while (!((limit || replaying) && batch_ring.completedCount() >= limit) &&
+           (replaying || elapsed < config.duration_sec) && !command_log.error()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        elapsed = (nowNanos() - start_ns) / 1e9;
+    }
+    __atomic_store_n(&stop_input, true, __ATOMIC_SEQ_CST);
+    txn_source.stop();
+    sequencer_thread.join();
 
-    uint64_t total_commits = 0;
-    for (const auto& result : AllResult) {
-        total_commits += result.commit_cnt_;
+    // with a log kept, every batch that reached it is executed before the
+    // workers stop, so the digest below is the state a replay of the log
+    // reaches; the run's time includes this drain
+    if (command_log.isOpen()) {
+        while (batch_ring.retiredBatches() < batch_ring.sequencedBatches() && !command_log.error()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    __atomic_store_n(&quit, true, __ATOMIC_SEQ_CST);
+    elapsed = (nowNanos() - start_ns) / 1e9;
+    if (checkpoint_thread.joinable()) checkpoint_thread.join();
+    for (auto& worker : workers) worker.join();
+    for (auto& reader : readers) reader.join();
+    command_log.close();
+    if (int error = command_log.error()) {
+        throw std::system_error(error, std::generic_category(),
+                                std::string(command_log.failedCall()) + " " + config.log_path);
     }
 
-    std::cout << "Throughput: " << total_commits / EX_TIME << " txn/sec" << std::endl;
-    return 0;
+    RunReport report;
+    report.elapsed_sec = elapsed;
+    report.load_sec = load_sec;
+    report.results = AllResult;
+    report.avg_chain_length = averageChainLength();
+    report.avg_cc_threads = split.averageCCThreads();
+    if (config.adaptive_split) {
+        std::cout << "[SPLIT] " << report.avg_cc_threads << " CC threads per batch on average, "
+                  << split.changes() << " changes" << std::endl;
+    }
+    if (config.log_sync != LogSync::OFF) report.log = command_log.stats();
+    if (config.log_sync != LogSync::OFF || replaying) {
+        std::cout << "[LOG] " << (replaying ? "replayed " : "logged ") << batch_ring.completedCount()
+                  << " transactions, table digest " << std::hex << tableDigest() << std::dec
+                  << std::endl;
+    }
+    return report;
 }
@@ -0,0 +1,29 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstddef>
+#include <iostream>
+
+// Check Macro Shared by the Tests: a Failed Check Is Reported With Its Line
+// and Counted, Any Thread May Check, and main() Returns checkResult().
+inline size_t failures = 0;
+
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            __atomic_add_fetch(&failures, 1, __ATOMIC_RELAXED);                       \
+            std::cerr << "FAILED " << __FILE__ << ":" << __LINE__ << ": " #condition  \
+                      << std::endl;                                                   \
+        }                                                                             \
+    } while (0)
+
+inline int checkResult() {
+    if (failures) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
+
+#endif // CHECK_HPP
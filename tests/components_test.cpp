@@ -0,0 +1,307 @@
+#include "metrics.hpp"
+#include "partitioner.hpp"
+#include "command_log.hpp"
+#include "snapshot.hpp"
+#include "split_controller.hpp"
+#include "check.hpp"
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Tests of the Single-Threaded Building Blocks of the Benchmark
+// Percentile maths, record ownership, the command log and snapshot file
+// formats read back after writing, and the decisions of the adaptive split.
+
+// Scratch File Unique to This Process, Removed When the Test Is Done
+struct TempPath {
+    std::string path_;
+    explicit TempPath(const char* name)
+        : path_((std::filesystem::temp_directory_path() /
+                 (std::string("bohm_test_") + name + "_" + std::to_string(getpid()))).string()) {}
+    ~TempPath() {
+        std::filesystem::remove(path_);
+        std::filesystem::remove(path_ + ".tmp");
+    }
+};
+
+// Values Below 2^SUB_BITS Are Exact; Larger Ones Land Within a Bucket's
+// Relative Error Above the True Quantile, and Never Beyond the Maximum
+void testHistogram() {
+    LatencyHistogram empty;
+    CHECK(empty.percentile(0.99) == 0);
+    CHECK(empty.mean() == 0.0);
+
+    LatencyHistogram exact;
+    for (uint64_t value = 0; value < LatencyHistogram::SUB_COUNT; ++value) exact.record(value);
+    CHECK(exact.percentile(0.0) == 0);
+    CHECK(exact.percentile(0.5) == 7);
+    CHECK(exact.percentile(1.0) == LatencyHistogram::SUB_COUNT - 1);
+
+    LatencyHistogram low, high;
+    for (uint64_t value = 1; value <= 1000; ++value) low.record(value);
+    for (uint64_t value = 1001; value <= 2000; ++value) high.record(value * 1000);
+    CHECK(low.count() == 1000 && low.max() == 1000);
+    CHECK(low.mean() == 500.5);
+    uint64_t median = low.percentile(0.5);
+    CHECK(median >= 500 && median <= 500 * 1.07);
+    uint64_t p99 = low.percentile(0.99);
+    CHECK(p99 >= 990 && p99 <= 1000);
+    CHECK(low.percentile(1.0) == 1000);
+
+    // Merged, the Lower Half Is Exactly the First Histogram
+    low.merge(high);
+    CHECK(low.count() == 2000 && low.max() == 2000000);
+    CHECK(low.percentile(0.25) <= 500 * 1.07);
+    uint64_t upper = low.percentile(0.75);
+    CHECK(upper >= 1500000 && upper <= 1500000 * 1.07);
+    CHECK(low.percentile(0.999) <= 2000000);
+}
+
+// Every Strategy Deals Every Key to One Thread in Range, and forEachOwned
+// Enumerates Exactly the Keys owner() Gives Each Thread
+void testPartitioner() {
+    const size_t thread_num = 4;
+    const uint64_t tuple_num = 1001;
+    for (PartitionStrategy strategy : {PartitionStrategy::MODULO, PartitionStrategy::RANGE,
+                                       PartitionStrategy::HASH, PartitionStrategy::TABLE}) {
+        Partitioner partitioner;
+        partitioner.build(strategy, thread_num, tuple_num);
+        CHECK(parsePartitionStrategy(partitionStrategyName(strategy)) == strategy);
+        std::vector<size_t> owned(thread_num, 0);
+        for (uint64_t key = 0; key < tuple_num; ++key) {
+            int owner = partitioner.owner(key);
+            CHECK(owner >= 0 && owner < static_cast<int>(thread_num));
+            if (owner < 0 || owner >= static_cast<int>(thread_num)) continue;
+            CHECK(partitioner.owns(owner, key));
+            owned[owner]++;
+        }
+        // Keys Past the Loaded Ones (Inserts) Have Owners Too
+        CHECK(partitioner.owner(UINT64_MAX) >= 0 && partitioner.owner(UINT64_MAX) < static_cast<int>(thread_num));
+        for (size_t count : owned) CHECK(count > tuple_num / thread_num * 3 / 4);
+
+        CHECK(partitioner.enumerable() ==
+              (strategy == PartitionStrategy::MODULO || strategy == PartitionStrategy::RANGE));
+        if (!partitioner.enumerable()) continue;
+        for (size_t thread_id = 0; thread_id < thread_num; ++thread_id) {
+            size_t visited = 0;
+            uint64_t previous = 0;
+            partitioner.forEachOwned(thread_id, tuple_num, [&](uint64_t key) {
+                CHECK(key < tuple_num && partitioner.owner(key) == static_cast<int>(thread_id));
+                CHECK(visited == 0 || key > previous);
+                previous = key;
+                visited++;
+            });
+            CHECK(visited == owned[thread_id]);
+        }
+    }
+
+    Partitioner modulo;
+    modulo.build(PartitionStrategy::MODULO, 3, 10);
+    CHECK(modulo.owner(7) == 1);
+    Partitioner range;
+    range.build(PartitionStrategy::RANGE, 4, 100);
+    CHECK(range.owner(24) == 0 && range.owner(25) == 1 && range.owner(99) == 3 && range.owner(1000) == 3);
+    Partitioner table;
+    table.build(PartitionStrategy::TABLE, 4, 100);
+    CHECK(table.owner(6) == 2);
+    table.assign(6, 3);
+    CHECK(table.owner(6) == 3 && table.owner(106) == 2);
+}
+
+// Batches Written Through the Writer Thread Read Back Word for Word; a Torn
+// Tail or a Corrupt Record Ends the Log at the Last Intact Batch Before It
+void testCommandLog() {
+    TempPath file("log");
+    std::vector<std::vector<uint64_t>> words;
+    uint64_t durable = 0;
+    {
+        CommandLog log;
+        log.open(file.path_, LogSync::BATCH, 0, [&durable](uint64_t count) {
+            __atomic_store_n(&durable, count, __ATOMIC_RELEASE);
+        });
+        uint64_t timestamp = 1;
+        for (uint64_t batch_id = 0; batch_id < 5; ++batch_id) {
+            uint64_t descriptor = logTransaction(2);
+            logOperation(descriptor, 0, 1);
+            logOperation(descriptor, 1, 2);
+            words.push_back({descriptor, batch_id * 100, UINT64_MAX - batch_id, 10});
+            log.append(batch_id, timestamp, 1, words.back());
+            timestamp += 1;
+        }
+        log.close();
+        CHECK(log.error() == 0);
+        CHECK(log.stats().batches_ == 5);
+    }
+    CHECK(__atomic_load_n(&durable, __ATOMIC_ACQUIRE) == 5);
+
+    std::vector<LoggedBatch> batches = readCommandLog(file.path_);
+    CHECK(batches.size() == 5);
+    for (size_t i = 0; i < batches.size() && i < words.size(); ++i) {
+        CHECK(batches[i].batch_id_ == i && batches[i].first_timestamp_ == i + 1 && batches[i].txn_num_ == 1);
+        CHECK(batches[i].words_ == words[i]);
+    }
+    uint64_t descriptor = batches.empty() ? 0 : batches[0].words_[0];
+    CHECK(loggedTaskNum(descriptor) == 2 && loggedOperation(descriptor, 0) == 1 &&
+          loggedOperation(descriptor, 1) == 2);
+
+    // A Crash Mid-Write Leaves Part of the Last Batch
+    uintmax_t size = std::filesystem::file_size(file.path_);
+    std::filesystem::resize_file(file.path_, size - 3);
+    CHECK(readCommandLog(file.path_).size() == 4);
+    std::filesystem::resize_file(file.path_, size - sizeof(LogBatchHeader) - 4 * sizeof(uint64_t) + 5);
+    CHECK(readCommandLog(file.path_).size() == 4);
+
+    // A Flipped Word in Batch 2 Fails Its Checksum
+    {
+        std::fstream stream(file.path_, std::ios::in | std::ios::out | std::ios::binary);
+        size_t record = sizeof(LogBatchHeader) + 4 * sizeof(uint64_t);
+        stream.seekp(2 * record + sizeof(LogBatchHeader) + sizeof(uint64_t));
+        uint64_t garbage = 0xdeadbeef;
+        stream.write(reinterpret_cast<const char*>(&garbage), sizeof(garbage));
+    }
+    CHECK(readCommandLog(file.path_).size() == 2);
+
+    bool threw = false;
+    try {
+        readCommandLog(file.path_ + ".missing");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+// A Snapshot Maps Back With the Header, Keys and Images Written; a
+// Cancelled One Leaves No File, and Records That Change Count Are an Error
+void testSnapshot() {
+    TempPath file("snapshot");
+    const uint64_t payload = 16;
+    std::vector<uint64_t> keys = {5, 9, 100, 1ULL << 40};
+    auto image = [](uint64_t key, char* out) {
+        for (uint64_t i = 0; i < payload; ++i) out[i] = static_cast<char>(key * 7 + i);
+    };
+    auto records = [&](auto emit) {
+        char buffer[payload];
+        for (uint64_t key : keys) {
+            image(key, buffer);
+            emit(key, std::span<const char>(buffer, payload));
+        }
+    };
+    SnapshotHeader header{SnapshotHeader::MAGIC, 42, keys.size(), payload, 100, 1};
+    CHECK(writeSnapshot(file.path_, header, records, [] { return false; }));
+    CHECK(!std::filesystem::exists(file.path_ + ".tmp"));
+
+    MappedSnapshot snapshot;
+    snapshot.open(file.path_);
+    CHECK(snapshot.isOpen());
+    CHECK(snapshot.header().timestamp_ == 42 && snapshot.header().record_num_ == keys.size());
+    CHECK(snapshot.header().payload_size_ == payload && snapshot.header().tuple_num_ == 100 &&
+          snapshot.header().sparse_ == 1);
+    char expected[payload];
+    for (uint64_t record = 0; record < keys.size(); ++record) {
+        CHECK(snapshot.key(record) == keys[record]);
+        image(keys[record], expected);
+        CHECK(std::memcmp(snapshot.image(record), expected, payload) == 0);
+    }
+    snapshot.release();
+
+    // Cancelled Before the First Flush Completes Nothing; the Old File Stays
+    std::vector<uint64_t> many(200000);
+    for (uint64_t i = 0; i < many.size(); ++i) many[i] = i;
+    auto many_records = [&](auto emit) {
+        char buffer[payload] = {};
+        for (uint64_t key : many) emit(key, std::span<const char>(buffer, payload));
+    };
+    SnapshotHeader big{SnapshotHeader::MAGIC, 43, many.size(), payload, many.size(), 0};
+    CHECK(!writeSnapshot(file.path_, big, many_records, [] { return true; }));
+    CHECK(!std::filesystem::exists(file.path_ + ".tmp"));
+    snapshot.open(file.path_);
+    CHECK(snapshot.header().timestamp_ == 42);
+    snapshot.release();
+
+    SnapshotHeader wrong = header;
+    wrong.record_num_ = keys.size() + 1;
+    bool threw = false;
+    try {
+        writeSnapshot(file.path_, wrong, records, [] { return false; });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(!std::filesystem::exists(file.path_ + ".tmp"));
+
+    std::ofstream(file.path_) << "not a snapshot";
+    threw = false;
+    try {
+        snapshot.open(file.path_);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+// Stand-In for the Batch Ring: Only What the Split Controller Reads
+struct RingProgress {
+    uint64_t released_ = 0;
+    uint64_t retired_ = 0;
+    uint64_t releasedBatches() const { return released_; }
+    uint64_t retiredBatches() const { return retired_; }
+};
+
+// A Fixed Split Never Moves; an Adaptive One Moves One Worker per Decision,
+// Every SPLIT_INTERVAL Batches, to the Lagging Side When Busy Time Agrees,
+// and Keeps at Least One Worker on Each Side
+void testSplitController() {
+    RingProgress ring;
+    SplitController fixed;
+    fixed.init(4, 2, false);
+    fixed.addCC(0, 1000000);
+    for (uint64_t batch_id = 0; batch_id < 4 * SPLIT_INTERVAL; ++batch_id) {
+        CHECK(fixed.ccThreads(batch_id, ring) == 2);
+    }
+    CHECK(fixed.changes() == 0 && fixed.averageCCThreads() == 2.0);
+
+    SplitController split;
+    split.init(4, 1, true);
+    uint64_t batch_id = 0;
+    // Runs the batches up to the next decision, checking the split holds between decisions
+    auto decide = [&](uint64_t cc_ns, uint64_t exec_ns) {
+        split.addCC(0, cc_ns);
+        split.addExecution(3, exec_ns);
+        size_t cc_threads = split.ccThreads(batch_id++, ring);
+        for (size_t i = 1; i < SPLIT_INTERVAL; ++i) CHECK(split.ccThreads(batch_id++, ring) == cc_threads);
+        return cc_threads;
+    };
+    CHECK(decide(0, 0) == 1); // Batches 0 .. SPLIT_INTERVAL - 1 Come Before Any Decision
+
+    // The CC Phase Lags and Is the Busier: One More CC Thread per Decision, up to 3 of 4
+    CHECK(decide(900, 100) == 2);
+    CHECK(decide(0, 0) == 2); // Nothing Measured Since the Last Decision
+    CHECK(decide(900, 100) == 3);
+    CHECK(decide(900, 100) == 3);
+    CHECK(split.changes() == 2);
+
+    // Execution Lags, but the CC Phase Is Still Busier: the Two Disagree, Nothing Moves
+    ring.released_ = batch_id;
+    CHECK(decide(900, 100) == 3);
+
+    // Execution Lags and Is the Busier: Back Down, but Never Below One CC Thread
+    CHECK(decide(100, 900) == 2);
+    CHECK(decide(100, 900) == 1);
+    CHECK(decide(0, 1000) == 1);
+    CHECK(split.changes() == 4);
+    CHECK(split.averageCCThreads() > 1.0 && split.averageCCThreads() < 3.0);
+}
+
+int main() {
+    testHistogram();
+    testPartitioner();
+    testCommandLog();
+    testSnapshot();
+    testSplitController();
+    return checkResult();
+}
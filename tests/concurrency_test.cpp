@@ -0,0 +1,243 @@
+#include "ordered_index.hpp"
+#include "hash_index.hpp"
+#include "work_stealing_deque.hpp"
+#include "bounded_queue.hpp"
+#include "tuple.hpp"
+#include "workload.hpp"
+#include "check.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+// Behavioral Tests of the Concurrent Structures the Pipeline Relies On
+// Each test races its writers against readers or thieves and checks what the
+// readers saw against what had been published before they looked. A failed
+// check is reported with its line; the process exits nonzero if any failed.
+
+constexpr size_t READER_NUM = 3;
+
+// One Writer Inserts Keys in Random Order While Readers Look Up and Scan
+// Every Key Inserted Before They Started Must Be Found With Its Value, and
+// Scans Must Return Ascending Keys Within Their Range.
+void testOrderedIndex() {
+    const size_t key_num = 200000;
+    std::vector<uint64_t> values(key_num);
+    std::vector<uint64_t> order(key_num);
+    std::iota(order.begin(), order.end(), 0);
+    FastRandom rng(7);
+    for (size_t i = key_num - 1; i > 0; --i) std::swap(order[i], order[rng.next() % (i + 1)]);
+    std::vector<uint64_t> position(key_num);
+    for (size_t i = 0; i < key_num; ++i) position[order[i]] = i;
+
+    OrderedIndex<uint64_t*> index;
+    uint64_t inserted = 0; // Prefix of order Published to the Readers
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < READER_NUM; ++r) {
+        readers.emplace_back([&, r] {
+            FastRandom rng(r + 1);
+            std::vector<uint64_t> found;
+            while (true) {
+                uint64_t published = __atomic_load_n(&inserted, __ATOMIC_ACQUIRE);
+                if (published == key_num) break;
+                if (published == 0) continue;
+                uint64_t key = order[rng.next() % published];
+                std::optional<uint64_t*> value = index.find(key);
+                CHECK(value && *value == &values[key]);
+
+                uint64_t first = rng.next() % key_num;
+                uint64_t last = std::min<uint64_t>(key_num - 1, first + 200);
+                found.clear();
+                index.scan(first, last, [&](uint64_t key, uint64_t* value) {
+                    CHECK(key >= first && key <= last && value == &values[key]);
+                    CHECK(found.empty() || found.back() < key);
+                    found.push_back(key);
+                });
+                size_t next = 0;
+                for (uint64_t key = first; key <= last; ++key) {
+                    bool present = next < found.size() && found[next] == key;
+                    if (present) ++next;
+                    if (position[key] < published) CHECK(present);
+                }
+            }
+        });
+    }
+    for (size_t i = 0; i < key_num; ++i) {
+        CHECK(index.insert(order[i], &values[order[i]]));
+        __atomic_store_n(&inserted, i + 1, __ATOMIC_RELEASE);
+    }
+    for (auto& reader : readers) reader.join();
+    CHECK(!index.insert(order[0], &values[order[0]]));
+    CHECK(index.size() == key_num);
+    uint64_t expected = 0;
+    index.scan(0, UINT64_MAX, [&](uint64_t key, uint64_t*) { CHECK(key == expected++); });
+    CHECK(expected == key_num);
+}
+
+// Several Inserters, Each Owning Its Keys, Grow a Small Table While Readers
+// Look Up What Each Has Published and Keys That Are Never Inserted
+void testHashIndex() {
+    const size_t inserter_num = 4;
+    const size_t per_inserter = 50000;
+    std::vector<uint64_t> values(inserter_num * per_inserter);
+    auto keyOf = [](size_t i) { return i * 0x9e3779b97f4a7c15ULL; };
+
+    HashIndex<uint64_t*> index;
+    index.reset(64);
+    std::vector<uint64_t> published(inserter_num, 0);
+    bool done = false;
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < READER_NUM; ++r) {
+        threads.emplace_back([&, r] {
+            FastRandom rng(r + 11);
+            while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+                size_t t = rng.next() % inserter_num;
+                uint64_t count = __atomic_load_n(&published[t], __ATOMIC_ACQUIRE);
+                if (count > 0) {
+                    size_t i = t + (rng.next() % count) * inserter_num;
+                    CHECK(index.find(keyOf(i)) == &values[i]);
+                }
+                CHECK(index.find(keyOf(values.size() + rng.next() % values.size())) == nullptr);
+            }
+        });
+    }
+    std::vector<std::thread> inserters;
+    for (size_t t = 0; t < inserter_num; ++t) {
+        inserters.emplace_back([&, t] {
+            for (size_t n = 0; n < per_inserter; ++n) {
+                size_t i = t + n * inserter_num;
+                CHECK(index.insert(keyOf(i), &values[i]));
+                __atomic_store_n(&published[t], n + 1, __ATOMIC_RELEASE);
+            }
+        });
+    }
+    for (auto& inserter : inserters) inserter.join();
+    __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+    for (auto& thread : threads) thread.join();
+    for (size_t i = 0; i < values.size(); ++i) CHECK(index.find(keyOf(i)) == &values[i]);
+    CHECK(!index.insert(keyOf(0), &values[0]));
+}
+
+// The Owner Pushes and Pops While Thieves Steal: Every Item Is Taken Exactly Once
+void testWorkStealingDeque() {
+    const size_t item_num = 200000;
+    std::vector<uint32_t> items(item_num, 0);  // Times Each Item Was Taken
+    WorkStealingDeque<uint32_t> deque(item_num);
+    bool done = false;
+    std::vector<std::thread> thieves;
+    for (size_t r = 0; r < READER_NUM; ++r) {
+        thieves.emplace_back([&] {
+            while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+                if (uint32_t* item = deque.steal()) __atomic_add_fetch(item, 1, __ATOMIC_RELAXED);
+            }
+        });
+    }
+    FastRandom rng(3);
+    for (size_t i = 0; i < item_num; ++i) {
+        deque.push(&items[i]);
+        // Pop Now and Then, Often Down to the Last Item to Race the Thieves for It
+        if (rng.next() % 3 == 0) {
+            while (uint32_t* item = deque.pop()) {
+                __atomic_add_fetch(item, 1, __ATOMIC_RELAXED);
+                if (rng.next() % 2) break;
+            }
+        }
+    }
+    while (uint32_t* item = deque.pop()) __atomic_add_fetch(item, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+    for (auto& thief : thieves) thief.join();
+    size_t wrong = 0;
+    for (uint32_t taken : items) wrong += taken != 1;
+    CHECK(wrong == 0);
+}
+
+// Producers and Consumers Share a Small Queue: Every Value Arrives Exactly Once
+void testBoundedQueue() {
+    const size_t producer_num = 2;
+    const uint64_t per_producer = 100000;
+    BoundedQueue<uint64_t> queue(64);
+    std::vector<uint32_t> received(producer_num * per_producer, 0);
+    uint64_t consumed = 0;
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producer_num; ++p) {
+        threads.emplace_back([&, p] {
+            for (uint64_t n = 0; n < per_producer; ++n) {
+                uint64_t value = p * per_producer + n;
+                while (!queue.tryPush(value)) std::this_thread::yield();
+            }
+        });
+    }
+    for (size_t c = 0; c < 2; ++c) {
+        threads.emplace_back([&] {
+            uint64_t value;
+            while (__atomic_load_n(&consumed, __ATOMIC_RELAXED) < received.size()) {
+                if (!queue.tryPop(value)) continue;
+                __atomic_add_fetch(&received[value], 1, __ATOMIC_RELAXED);
+                __atomic_add_fetch(&consumed, 1, __ATOMIC_RELAXED);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    size_t wrong = 0;
+    for (uint32_t count : received) wrong += count != 1;
+    CHECK(wrong == 0);
+    CHECK(queue.empty());
+}
+
+// One Writer Adds and Fills a Placeholder per Timestamp While Readers Read at
+// Committed Timestamps: Every Word of the Image Read at t Must Be t, So a
+// Reader Never Sees a Torn Image or the Wrong Version
+void testTupleReads() {
+    const uint64_t version_num = 200000;
+    const uint32_t payload_size = 64;
+    std::vector<char> initial(payload_size, 0);
+    VersionArena arena(ARENA_SLAB_SIZE, Tuple::versionSize(payload_size));
+    Tuple tuple(initial.data(), payload_size);
+    uint64_t committed = 0; // Every Timestamp up to It Is Filled
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < READER_NUM; ++r) {
+        readers.emplace_back([&, r] {
+            FastRandom rng(r + 21);
+            while (true) {
+                uint64_t last = __atomic_load_n(&committed, __ATOMIC_ACQUIRE);
+                if (last == version_num) break;
+                // Mostly the Newest Versions, Which Race the Writer
+                uint64_t timestamp = rng.next() % 4 ? last : rng.next() % (last + 1);
+                Tuple::Version* pending = nullptr;
+                std::optional<Payload> image = tuple.read(timestamp, pending);
+                CHECK(image.has_value());
+                if (!image) continue;
+                for (size_t offset = 0; offset < payload_size; offset += sizeof(uint64_t)) {
+                    uint64_t word;
+                    std::memcpy(&word, image->data() + offset, sizeof(word));
+                    if (word != timestamp) {
+                        CHECK(word == timestamp);
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for (uint64_t timestamp = 1; timestamp <= version_num; ++timestamp) {
+        Tuple::Version* version = tuple.addPlaceholder(timestamp, arena);
+        std::span<char> image = tuple.image(version);
+        for (size_t offset = 0; offset < image.size(); offset += sizeof(timestamp)) {
+            std::memcpy(image.data() + offset, &timestamp, sizeof(timestamp));
+        }
+        CHECK(tuple.fillPlaceholder(version) == nullptr);
+        __atomic_store_n(&committed, timestamp, __ATOMIC_RELEASE);
+    }
+    for (auto& reader : readers) reader.join();
+}
+
+int main() {
+    testOrderedIndex();
+    testHashIndex();
+    testWorkStealingDeque();
+    testBoundedQueue();
+    testTupleReads();
+    return checkResult();
+}